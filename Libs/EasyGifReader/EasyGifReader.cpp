@@ -11,6 +11,7 @@
 
 #include "EasyGifReader.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <algorithm>
 #include <gif_lib.h>
@@ -33,6 +34,7 @@ struct EasyGifReader::Internal {
     };
     int loopCount;
     size_t pixelBufferSize;
+    size_t rasterSize;
 
     static Error translateErrorCode(int error);
     static FrameBounds frameBounds(GifFileType *gif, int imageIndex);
@@ -512,6 +514,11 @@ EasyGifReader::EasyGifReader(Internal *data) : data(data) {
         }
     }
     data->pixelBufferSize = pxSize*(frameArea+prevFrameArea);
+    data->rasterSize = 0;
+    for (int i = 0; i < data->gif->ImageCount; ++i) {
+        if (data->gif->SavedImages[i].RasterBits)
+            data->rasterSize += (size_t) data->gif->SavedImages[i].ImageDesc.Width*(size_t) data->gif->SavedImages[i].ImageDesc.Height;
+    }
 }
 
 EasyGifReader::EasyGifReader(EasyGifReader &&orig) : data(orig.data) {
@@ -568,3 +575,20 @@ EasyGifReader::FrameIterator EasyGifReader::end() const {
 EasyGifReader::FrameIterator EasyGifReader::loopEnd() const {
     return FrameIterator(this, FrameIterator::LOOP_END);
 }
+
+void EasyGifReader::releaseFrameData(int frameIndex) {
+    if (!(data && data->gif) || frameIndex < 0 || frameIndex >= data->gif->ImageCount)
+        throw Error::INVALID_OPERATION;
+    SavedImage &image = data->gif->SavedImages[frameIndex];
+    if (image.RasterBits) {
+        data->rasterSize -= (size_t) image.ImageDesc.Width*(size_t) image.ImageDesc.Height;
+        free(image.RasterBits);
+        image.RasterBits = nullptr;
+    }
+}
+
+std::size_t EasyGifReader::residentBytes() const {
+    if (!data)
+        return 0;
+    return data->rasterSize+data->pixelBufferSize;
+}
@@ -116,6 +116,12 @@ public:
     FrameIterator end() const;
     FrameIterator loopEnd() const;
 
+    // Frees the color index data of a frame once it has been composited.
+    // The frame cannot be iterated over again afterwards.
+    void releaseFrameData(int frameIndex);
+    // Bytes currently held by frame index data plus one frame's pixel buffer
+    std::size_t residentBytes() const;
+
 private:
     Internal *data;
 
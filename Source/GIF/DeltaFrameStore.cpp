@@ -0,0 +1,77 @@
+#include "DeltaFrameStore.h"
+
+DeltaFrameStore::DeltaFrameStore(int w, int h, int interval)
+    : width(w), height(h), keyframeInterval(std::max(1, interval))
+{
+}
+
+void DeltaFrameStore::addKeyframe(const juce::Image& frame)
+{
+    jassert(isKeyframeIndex(getFrameCount()));
+    jassert(frame.getWidth() == width && frame.getHeight() == height);
+    entries.push_back({frame, {}});
+    residentBytes += imageBytes(frame);
+}
+
+void DeltaFrameStore::addDelta(const juce::Image& patch, juce::Point<int> position)
+{
+    jassert(!isKeyframeIndex(getFrameCount()));
+    entries.push_back({patch, position});
+    residentBytes += imageBytes(patch);
+}
+
+void DeltaFrameStore::renderFrame(int index, juce::Image& canvas, int& canvasFrameIndex) const
+{
+    if (entries.empty())
+        return;
+
+    index = std::clamp(index, 0, getFrameCount() - 1);
+
+    if (index == canvasFrameIndex)
+        return;
+
+    // The canvas is written in place, so it must never share pixels with a keyframe
+    if (!canvas.isValid() || canvas.getWidth() != width || canvas.getHeight() != height)
+    {
+        canvas = juce::Image(juce::Image::ARGB, width, height, false);
+        canvasFrameIndex = -1;
+    }
+
+    int keyframe = index - index % keyframeInterval;
+
+    // Patch forward from the current canvas only if no keyframe lies in between
+    if (canvasFrameIndex < keyframe || canvasFrameIndex > index)
+    {
+        copyPixels(entries[static_cast<size_t>(keyframe)].pixels, canvas, {});
+        canvasFrameIndex = keyframe;
+    }
+
+    for (int i = canvasFrameIndex + 1; i <= index; ++i)
+    {
+        const auto& entry = entries[static_cast<size_t>(i)];
+        if (entry.pixels.isValid())
+            copyPixels(entry.pixels, canvas, entry.position);
+    }
+
+    canvasFrameIndex = index;
+}
+
+size_t DeltaFrameStore::imageBytes(const juce::Image& image)
+{
+    if (!image.isValid())
+        return 0;
+
+    return static_cast<size_t>(image.getWidth()) * static_cast<size_t>(image.getHeight()) * 4;
+}
+
+void DeltaFrameStore::copyPixels(const juce::Image& source, juce::Image& dest, juce::Point<int> position)
+{
+    juce::Image::BitmapData src(source, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dst(dest, position.x, position.y, source.getWidth(), source.getHeight(),
+                                juce::Image::BitmapData::writeOnly);
+
+    // Both images are ARGB, so rows can be copied verbatim
+    const size_t rowBytes = static_cast<size_t>(src.width) * static_cast<size_t>(src.pixelStride);
+    for (int y = 0; y < src.height; ++y)
+        std::memcpy(dst.getLinePointer(y), src.getLinePointer(y), rowBytes);
+}
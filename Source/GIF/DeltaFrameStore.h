@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Compact frame storage: a full keyframe every N frames, and between them only
+// the rectangle that changed since the previous frame.
+// Frames are rebuilt into a caller-owned canvas. Stepping forward patches the
+// canvas in place; any other jump restarts from the nearest keyframe.
+class DeltaFrameStore
+{
+public:
+    DeltaFrameStore(int width, int height, int keyframeInterval);
+
+    // True if the frame at this index must be added as a full keyframe
+    bool isKeyframeIndex(int index) const { return index % keyframeInterval == 0; }
+
+    // Append the next frame (full canvas size)
+    void addKeyframe(const juce::Image& frame);
+
+    // Append the next frame as the changed region only (null image = no change)
+    void addDelta(const juce::Image& patch, juce::Point<int> position);
+
+    // Bring canvas to the given frame. canvasFrameIndex is the frame the canvas
+    // currently holds (-1 if unknown) and is updated on return.
+    void renderFrame(int index, juce::Image& canvas, int& canvasFrameIndex) const;
+
+    int getFrameCount() const { return static_cast<int>(entries.size()); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Bytes held by keyframes and patches
+    size_t getResidentBytes() const { return residentBytes; }
+
+private:
+    struct Entry
+    {
+        juce::Image pixels;
+        juce::Point<int> position;
+    };
+
+    static size_t imageBytes(const juce::Image& image);
+    static void copyPixels(const juce::Image& source, juce::Image& dest, juce::Point<int> position);
+
+    std::vector<Entry> entries;
+    int width = 0;
+    int height = 0;
+    int keyframeInterval = 1;
+    size_t residentBytes = 0;
+};
@@ -0,0 +1,117 @@
+#include "FrameTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+void FrameTimeline::build(const std::vector<int>& frameDurations)
+{
+    starts.clear();
+    lookup.clear();
+
+    if (frameDurations.empty())
+        return;
+
+    int shortest = 0;
+    for (int duration : frameDurations)
+        if (duration > 0 && (shortest == 0 || duration < shortest))
+            shortest = duration;
+
+    if (shortest == 0)
+        shortest = 1;
+
+    double total = 0.0;
+    starts.reserve(frameDurations.size() + 1);
+    for (int duration : frameDurations)
+    {
+        starts.push_back(total);
+        total += std::max(duration, shortest);
+    }
+    starts.push_back(total);
+
+    for (auto& start : starts)
+        start /= total;
+    starts.back() = 1.0;
+
+    // Buckets no wider than the shortest frame hold at most two frame starts,
+    // so the search after the table read is a step or two
+    const double bucketsNeeded = std::ceil(total / shortest);
+    const int lookupSize = static_cast<int>(std::clamp(bucketsNeeded, 1.0, static_cast<double>(maxLookupSize)));
+
+    lookup.resize(static_cast<size_t>(lookupSize) + 1);
+    int frame = 0;
+    for (int bucket = 0; bucket < lookupSize; ++bucket)
+    {
+        const double bucketStart = static_cast<double>(bucket) / lookupSize;
+        while (starts[static_cast<size_t>(frame) + 1] <= bucketStart)
+            ++frame;
+        lookup[static_cast<size_t>(bucket)] = frame;
+    }
+    lookup.back() = getFrameCount() - 1;
+}
+
+void FrameTimeline::buildUniform(int frameCount)
+{
+    build(std::vector<int>(static_cast<size_t>(std::max(frameCount, 0)), 1));
+}
+
+int FrameTimeline::frameAtPosition(double position) const
+{
+    const int frameCount = getFrameCount();
+    if (frameCount <= 0)
+        return 0;
+
+    position = std::clamp(position, 0.0, 1.0);
+
+    const int lookupSize = static_cast<int>(lookup.size()) - 1;
+    const int bucket = std::min(static_cast<int>(position * lookupSize), lookupSize - 1);
+
+    // The frame is between the first frames of this bucket and the next
+    const auto first = starts.begin() + lookup[static_cast<size_t>(bucket)];
+    const auto last = starts.begin() + lookup[static_cast<size_t>(bucket) + 1] + 1;
+    const int frame = static_cast<int>(std::upper_bound(first, last, position) - starts.begin()) - 1;
+
+    return std::clamp(frame, 0, frameCount - 1);
+}
+
+double FrameTimeline::getFrameStart(int frame) const
+{
+    if (getFrameCount() <= 0)
+        return 0.0;
+
+    return starts[static_cast<size_t>(std::clamp(frame, 0, getFrameCount()))];
+}
+
+double FrameTimeline::phaseOfFrame(int frame, Direction direction) const
+{
+    switch (direction)
+    {
+        case Direction::Forward:
+            return getFrameStart(frame);
+
+        case Direction::Reverse:
+            return 1.0 - getFrameStart(frame + 1);
+
+        case Direction::PingPong:
+            return getFrameStart(frame) * 0.5;
+    }
+
+    return 0.0;
+}
+
+int FrameTimeline::frameAt(double phase, Direction direction) const
+{
+    switch (direction)
+    {
+        case Direction::Forward:
+            return frameAtPosition(phase);
+
+        case Direction::Reverse:
+            return frameAtPosition(1.0 - phase);
+
+        case Direction::PingPong:
+            return phase < 0.5 ? frameAtPosition(phase * 2.0)
+                               : frameAtPosition((1.0 - phase) * 2.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+// Maps a position within one beat cycle to a GIF frame, weighting each frame
+// by its own delay so hold frames stay on screen for their share of the beat.
+// Built once per loaded GIF; lookups are a table read plus a binary search
+// over the few frames that can start inside one table bucket.
+class FrameTimeline
+{
+public:
+    enum class Direction
+    {
+        Forward,
+        Reverse,
+        PingPong // Forward over the first half of the cycle, backward over the second
+    };
+
+    // Frame delays in any unit. Non-positive delays count as the shortest
+    // positive one; an empty list gives an empty timeline.
+    void build(const std::vector<int>& frameDurations);
+
+    // Every frame gets the same share of the cycle
+    void buildUniform(int frameCount);
+
+    int getFrameCount() const { return static_cast<int>(starts.size()) - 1; }
+
+    // Frame shown at phase (0.0 to 1.0) of the cycle
+    int frameAt(double phase, Direction direction) const;
+
+    // Frame index playing forward at position (0.0 to 1.0) of the whole animation
+    int frameAtPosition(double position) const;
+
+    // Position (0.0 to 1.0) at which frame starts playing forward;
+    // getFrameStart(getFrameCount()) is 1.0
+    double getFrameStart(int frame) const;
+
+    // Phase of the cycle at which frame starts in the given direction.
+    // In ping-pong this is its first showing, in the forward half.
+    double phaseOfFrame(int frame, Direction direction) const;
+
+private:
+    // Upper bound on table entries for GIFs with very uneven delays
+    static constexpr int maxLookupSize = 1 << 16;
+
+    // Start of each frame as a fraction of the animation, with 1.0 appended
+    std::vector<double> starts;
+
+    // First frame overlapping each of the equal buckets of [0, 1)
+    std::vector<int> lookup;
+};
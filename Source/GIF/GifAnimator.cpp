@@ -1,36 +1,305 @@
 #include "GifAnimator.h"
+#include "ImageResampler.h"
+#include "Utils/TraceRecorder.h"
+
+GifAnimator::GifAnimator()
+{
+    MemoryAccountant::getInstance().registerClient(this);
+}
+
+GifAnimator::~GifAnimator()
+{
+    MemoryAccountant::getInstance().unregisterClient(this);
+}
 
 bool GifAnimator::loadGif(const juce::File& file)
 {
-    auto result = GifLoader::loadFromFile(file);
+    auto result = decodeWithinBudget([&file](const auto& options, auto* status)
+    {
+        return GifLoader::loadFromFile(file, options, status);
+    });
+
     if (!result.has_value())
         return false;
 
-    frames = std::move(result->frames);
-    width = result->width;
-    height = result->height;
-    currentFrameIndex = 0;
-
+    setLoadedData(std::move(*result));
+    sourceFile = file;
+    sourceData.reset();
     return true;
 }
 
 bool GifAnimator::loadGif(const void* data, size_t size)
 {
-    auto result = GifLoader::loadFromMemory(data, size);
+    auto result = decodeWithinBudget([data, size](const auto& options, auto* status)
+    {
+        return GifLoader::loadFromMemory(data, size, options, status);
+    });
+
     if (!result.has_value())
         return false;
 
-    frames = std::move(result->frames);
-    width = result->width;
-    height = result->height;
-    currentFrameIndex = 0;
+    setLoadedData(std::move(*result));
+    sourceFile = juce::File();
+    sourceData.replaceAll(data, size);
+    return true;
+}
+
+bool GifAnimator::loadGif(juce::InputStream& stream)
+{
+    // Keep the compressed bytes so the GIF can be re-decoded at another size
+    juce::MemoryBlock data;
+    stream.readIntoMemoryBlock(data);
+    return loadGif(data.getData(), data.getSize());
+}
 
+void GifAnimator::setMaxDimension(int maxDimension)
+{
+    // Resolution the current GIF would be decoded at under a given limit
+    auto decodedSize = [this](int limit)
+    {
+        int w = sourceWidth;
+        int h = sourceHeight;
+        ImageResampler::fitWithin(w, h, limit);
+        return juce::Point<int>(w, h);
+    };
+
+    bool changesResolution = decodedSize(loadOptions.maxDimension) != decodedSize(maxDimension);
+    loadOptions.maxDimension = maxDimension;
+
+    if (changesResolution)
+        reloadFromSource();
+}
+
+bool GifAnimator::reloadFromSource()
+{
+    std::optional<GifLoader::GifData> result;
+
+    if (sourceFile != juce::File())
+    {
+        result = decodeWithinBudget([this](const auto& options, auto* status)
+        {
+            return GifLoader::loadFromFile(sourceFile, options, status);
+        });
+    }
+    else if (!sourceData.isEmpty())
+    {
+        result = decodeWithinBudget([this](const auto& options, auto* status)
+        {
+            return GifLoader::loadFromMemory(sourceData.getData(), sourceData.getSize(), options, status);
+        });
+    }
+
+    if (!result.has_value())
+        return false;
+
+    // Keep playing from the same frame, with the same shift from a MIDI jump
+    int frameIndex = currentFrameIndex;
+    double offset = loopOffset;
+    setLoadedData(std::move(*result));
+    setFrameIndex(std::clamp(frameIndex, 0, getFrameCount() - 1));
+    loopOffset = offset;
     return true;
 }
 
+std::optional<GifLoader::GifData> GifAnimator::decodeWithinBudget(const Decoder& decode)
+{
+    auto options = loadOptions;
+    options.byteBudget = getAvailableBytes();
+
+    // Nothing free: have the other instances drop their caches. A budget of
+    // 0 means no limit to the loader, so fail rather than pass it on.
+    if (options.byteBudget == 0)
+    {
+        MemoryAccountant::getInstance().reserve(this, 1);
+        options.byteBudget = getAvailableBytes();
+    }
+
+    if (options.byteBudget == 0)
+    {
+        lastLoadStatus = GifLoader::LoadStatus::OverBudget;
+        return std::nullopt;
+    }
+
+    return decodeWithRetries(decode, options, lastLoadStatus);
+}
+
+size_t GifAnimator::getAvailableBytes() const
+{
+    // A GIF being prepared keeps its share while this one loads
+    const size_t available = MemoryAccountant::getInstance().getAvailableBytes(this);
+    return available > prepareReservation ? available - prepareReservation : 0;
+}
+
+std::optional<GifLoader::GifData> GifAnimator::decodeWithRetries(const Decoder& decode, GifLoader::LoadOptions options,
+                                                                 GifLoader::LoadStatus& status)
+{
+    // The loader's size estimate can be beaten by GIFs whose frames barely
+    // repeat, so retry against a smaller target a few times
+    for (int attempt = 0; attempt < 4; ++attempt)
+    {
+        auto result = decode(options, &status);
+        if (result.has_value() || status != GifLoader::LoadStatus::OverBudget)
+            return result;
+
+        // Never down to 0, which would lift the limit
+        options.byteBudget /= 2;
+        if (options.byteBudget == 0)
+            break;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<GifLoader::LoadOptions> GifAnimator::reserveForPrepare(ColorFilterType filter)
+{
+    cancelPrepare();
+
+    // Take half of what's free beside the current GIF, leaving the rest for
+    // mip levels here and in other instances
+    const size_t resident = getResidentBytes();
+    const size_t available = getAvailableBytes();
+    const size_t reservation = available > resident ? (available - resident) / 2 : 0;
+
+    // Filtered copies take as much again as the frames
+    auto options = loadOptions;
+    options.byteBudget = filter != ColorFilterType::None ? reservation / 2 : reservation;
+
+    // Too tight for a GIF the size of this one: it would come out smaller
+    // than a load at the downbeat
+    if (options.byteBudget == 0 || options.byteBudget < resident
+        || !MemoryAccountant::getInstance().reserve(this, reservation))
+        return std::nullopt;
+
+    prepareReservation = reservation;
+    reportResidentBytes();
+    return options;
+}
+
+void GifAnimator::cancelPrepare()
+{
+    if (prepareReservation == 0)
+        return;
+
+    prepareReservation = 0;
+    reportResidentBytes();
+}
+
+std::optional<GifAnimator::PreparedGif> GifAnimator::prepare(const juce::File& file, const GifLoader::LoadOptions& options,
+                                                             ColorFilterType filter)
+{
+    GifLoader::LoadStatus status = GifLoader::LoadStatus::Ok;
+    auto prepared = finishPreparing(decodeWithRetries([&file](const auto& decodeOptions, auto* decodeStatus)
+    {
+        return GifLoader::loadFromFile(file, decodeOptions, decodeStatus);
+    }, options, status), filter);
+
+    if (prepared.has_value())
+        prepared->sourceFile = file;
+
+    return prepared;
+}
+
+std::optional<GifAnimator::PreparedGif> GifAnimator::prepare(const void* data, size_t size,
+                                                             const GifLoader::LoadOptions& options, ColorFilterType filter)
+{
+    GifLoader::LoadStatus status = GifLoader::LoadStatus::Ok;
+    auto prepared = finishPreparing(decodeWithRetries([data, size](const auto& decodeOptions, auto* decodeStatus)
+    {
+        return GifLoader::loadFromMemory(data, size, decodeOptions, decodeStatus);
+    }, options, status), filter);
+
+    if (prepared.has_value())
+        prepared->sourceData.replaceAll(data, size);
+
+    return prepared;
+}
+
+std::optional<GifAnimator::PreparedGif> GifAnimator::finishPreparing(std::optional<GifLoader::GifData>&& result,
+                                                                     ColorFilterType filter)
+{
+    if (!result.has_value())
+        return std::nullopt;
+
+    PreparedGif prepared;
+    prepared.data = std::move(*result);
+
+    // GIFs stored as deltas are filtered live instead
+    if (filter != ColorFilterType::None && prepared.data.deltaFrames == nullptr)
+    {
+        prepared.filter = filter;
+        prepared.filteredFrames.reserve(prepared.data.frames.size());
+        for (const auto& frame : prepared.data.frames)
+            prepared.filteredFrames.push_back(ColorFilter::apply(frame, filter));
+    }
+
+    return prepared;
+}
+
+void GifAnimator::adopt(PreparedGif&& prepared)
+{
+    prepareReservation = 0;
+    setLoadedData(std::move(prepared.data));
+    sourceFile = prepared.sourceFile;
+    sourceData = std::move(prepared.sourceData);
+    lastLoadStatus = GifLoader::LoadStatus::Ok;
+
+    filteredFrames = std::move(prepared.filteredFrames);
+    filteredFramesFilter = prepared.filter;
+    reportResidentBytes();
+}
+
+const juce::Image* GifAnimator::getPrefilteredFrame(ColorFilterType filter) const
+{
+    if (filter == ColorFilterType::None || filter != filteredFramesFilter
+        || currentFrameIndex >= static_cast<int>(filteredFrames.size()))
+        return nullptr;
+
+    return &filteredFrames[static_cast<size_t>(currentFrameIndex)];
+}
+
+size_t GifAnimator::releaseCaches()
+{
+    size_t before = getResidentBytes();
+    clearMipLevels();
+    clearFilteredFrames();
+    return before - getResidentBytes();
+}
+
+void GifAnimator::reportResidentBytes()
+{
+    MemoryAccountant::getInstance().setResidentBytes(this, getResidentBytes() + prepareReservation);
+}
+
+void GifAnimator::setLoadedData(GifLoader::GifData&& data)
+{
+    frames = std::move(data.frames);
+    deltaFrames = std::move(data.deltaFrames);
+    deltaCanvas = {};
+    deltaCanvasFrameIndex = -1;
+    clearMipLevels();
+    clearFilteredFrames();
+    width = data.width;
+    height = data.height;
+    timeline.build(data.frameDurationsMs);
+    sourceWidth = data.sourceWidth;
+    sourceHeight = data.sourceHeight;
+    peakDecodeBytes = data.peakDecodeBytes;
+    loopOffset = 0.0;
+    resetPlaybackStats();
+    setFrameIndex(0);
+    reportResidentBytes();
+}
+
 void GifAnimator::loadFrames(std::vector<juce::Image>&& newFrames)
 {
     frames = std::move(newFrames);
+    deltaFrames.reset();
+    deltaCanvas = {};
+    deltaCanvasFrameIndex = -1;
+    clearMipLevels();
+    clearFilteredFrames();
+    sourceFile = juce::File();
+    sourceData.reset();
     if (!frames.empty())
     {
         width = frames[0].getWidth();
@@ -41,67 +310,238 @@ void GifAnimator::loadFrames(std::vector<juce::Image>&& newFrames)
         width = 0;
         height = 0;
     }
+    sourceWidth = width;
+    sourceHeight = height;
+    timeline.buildUniform(static_cast<int>(frames.size()));
+    loopOffset = 0.0;
+    resetPlaybackStats();
     currentFrameIndex = 0;
+    reportResidentBytes();
 }
 
 void GifAnimator::update(double bpm, double ppqPosition, bool isPlaying,
                           int speedDivisor, bool reverse, bool pingPong)
 {
-    if (frames.empty())
+    juce::ignoreUnused(bpm);
+
+    BpmSync::LoopSettings settings;
+    settings.speedIndex = speedDivisor;
+    update(ppqPosition, isPlaying, BpmSync::makeLoopMapping(settings), reverse, pingPong);
+}
+
+void GifAnimator::update(double ppqPosition, bool isPlaying, const BpmSync::LoopMapping& mapping,
+                          bool reverse, bool pingPong)
+{
+    BOPPER_TRACE_SCOPE("GifAnimator::update");
+
+    if (!isLoaded())
         return;
 
     if (!isPlaying)
     {
         // When not playing, stay on current frame
+        hasSequenceStep = false;
         return;
     }
 
-    // Apply speed divisor: divide the ppq position to slow down the animation
-    double divisor = static_cast<double>(1 << speedDivisor); // 1, 2, 4, 8, 16
-    double adjustedPpq = ppqPosition / divisor;
+    // Position in loops since the mapping's origin; the fraction is the loop phase
+    double adjustedPpq = mapping.loopPosition(ppqPosition) - loopOffset;
 
     // Calculate beat phase (0.0 to 1.0)
     double beatPhase = BpmSync::beatPhase(adjustedPpq);
     currentBeatPhase = beatPhase;
 
-    int totalFrames = static_cast<int>(frames.size());
-    int newFrameIndex;
+    const int totalFrames = getFrameCount();
+
+    // Pick the frame from the GIF's own timing: each frame holds for its share
+    // of the beat. Ping-pong plays 0->N over the first half, N->0 over the second.
+    const auto direction = pingPong ? FrameTimeline::Direction::PingPong
+                         : reverse  ? FrameTimeline::Direction::Reverse
+                                    : FrameTimeline::Direction::Forward;
+    const int newFrameIndex = timeline.frameAt(beatPhase, direction);
+
+    // Count frame changes that were never shown. Ping-pong visits 2N frames per beat.
+    // Backwards steps and jumps of more than a cycle are transport relocations.
+    const int cycleLength = pingPong ? totalFrames * 2 : totalFrames;
+    int stepInCycle = newFrameIndex;
+    if (pingPong && beatPhase >= 0.5)
+        stepInCycle = totalFrames * 2 - 1 - newFrameIndex;
+    else if (!pingPong && reverse)
+        stepInCycle = totalFrames - 1 - newFrameIndex;
 
-    if (pingPong)
+    const auto sequenceStep = static_cast<juce::int64>(std::floor(adjustedPpq)) * cycleLength + stepInCycle;
+    if (hasSequenceStep)
     {
-        // Ping-pong: 0->N->0 over one beat cycle
-        // First half: forward (0.0-0.5 -> frames 0 to N-1)
-        // Second half: backward (0.5-1.0 -> frames N-1 to 0)
-        if (beatPhase < 0.5)
-        {
-            double forwardPhase = beatPhase * 2.0; // 0.0 to 1.0
-            newFrameIndex = static_cast<int>(forwardPhase * totalFrames);
-        }
-        else
+        const auto stepsTaken = sequenceStep - lastSequenceStep;
+        if (stepsTaken > 1 && stepsTaken <= cycleLength)
+            droppedFrameChanges += static_cast<int>(stepsTaken - 1);
+    }
+    lastSequenceStep = sequenceStep;
+    hasSequenceStep = true;
+
+    setFrameIndex(std::clamp(newFrameIndex, 0, totalFrames - 1));
+}
+
+void GifAnimator::jumpToFrame(int frameIndex, double ppqPosition, const BpmSync::LoopMapping& mapping,
+                              bool reverse, bool pingPong)
+{
+    if (!isLoaded())
+        return;
+
+    frameIndex = std::clamp(frameIndex, 0, getFrameCount() - 1);
+
+    const auto direction = pingPong ? FrameTimeline::Direction::PingPong
+                         : reverse  ? FrameTimeline::Direction::Reverse
+                                    : FrameTimeline::Direction::Forward;
+
+    // Only the fraction matters; keeping it small keeps the loop count exact
+    const double offset = mapping.loopPosition(ppqPosition) - timeline.phaseOfFrame(frameIndex, direction);
+    loopOffset = offset - std::floor(offset);
+
+    // A jump isn't a skipped frame
+    hasSequenceStep = false;
+    setFrameIndex(frameIndex);
+}
+
+void GifAnimator::setFrameIndex(int index)
+{
+    currentFrameIndex = index;
+
+    if (deltaFrames != nullptr)
+        deltaFrames->renderFrame(currentFrameIndex, deltaCanvas, deltaCanvasFrameIndex);
+}
+
+int GifAnimator::getFrameCount() const
+{
+    if (deltaFrames != nullptr)
+        return deltaFrames->getFrameCount();
+
+    return static_cast<int>(frames.size());
+}
+
+const juce::Image& GifAnimator::getCurrentFrame() const
+{
+    if (!isLoaded())
+        return blankImage;
+
+    if (deltaFrames != nullptr)
+        return deltaCanvas;
+
+    return frames[static_cast<size_t>(currentFrameIndex)];
+}
+
+const juce::Image& GifAnimator::getCurrentFrameForSize(int targetWidth, int targetHeight)
+{
+    const juce::Image& fullFrame = getCurrentFrame();
+    if (!isLoaded())
+        return fullFrame;
+
+    // Count how many halvings still cover the target
+    int levels = 0;
+    int w = fullFrame.getWidth();
+    int h = fullFrame.getHeight();
+    while ((w > 1 || h > 1)
+           && ImageResampler::halfSize(w) >= targetWidth
+           && ImageResampler::halfSize(h) >= targetHeight)
+    {
+        w = ImageResampler::halfSize(w);
+        h = ImageResampler::halfSize(h);
+        ++levels;
+    }
+
+    if (levels == 0)
+        return fullFrame;
+
+    std::vector<juce::Image>* chain = nullptr;
+
+    if (deltaFrames != nullptr)
+    {
+        if (canvasMipFrameIndex != deltaCanvasFrameIndex)
         {
-            double backwardPhase = (1.0 - beatPhase) * 2.0; // 1.0 to 0.0
-            newFrameIndex = static_cast<int>(backwardPhase * totalFrames);
+            canvasMipLevels.clear();
+            canvasMipFrameIndex = deltaCanvasFrameIndex;
         }
+        chain = &canvasMipLevels;
     }
-    else if (reverse)
+    else
     {
-        // Reverse: play from end to beginning
-        double reversePhase = 1.0 - beatPhase;
-        newFrameIndex = static_cast<int>(reversePhase * totalFrames);
+        mipLevels.resize(frames.size());
+        chain = &mipLevels[static_cast<size_t>(currentFrameIndex)];
     }
-    else
+
+    while (static_cast<int>(chain->size()) < levels)
     {
-        // Normal forward playback
-        newFrameIndex = BpmSync::frameIndexFromPhase(beatPhase, totalFrames);
+        const auto& source = chain->empty() ? fullFrame : chain->back();
+        const size_t levelBytes = static_cast<size_t>(ImageResampler::halfSize(source.getWidth()))
+                                * static_cast<size_t>(ImageResampler::halfSize(source.getHeight())) * 4;
+
+        // Out of budget: draw the largest level we have and let Graphics scale it
+        if (!MemoryAccountant::getInstance().reserve(this, levelBytes))
+            return source;
+
+        chain->push_back(buildHalfLevel(source));
+        reportResidentBytes();
     }
 
-    currentFrameIndex = std::clamp(newFrameIndex, 0, totalFrames - 1);
+    return (*chain)[static_cast<size_t>(levels - 1)];
 }
 
-const juce::Image& GifAnimator::getCurrentFrame() const
+size_t GifAnimator::getResidentBytes() const
 {
-    if (frames.empty())
-        return blankImage;
+    auto imageBytes = [](const juce::Image& image)
+    {
+        return image.isValid() ? static_cast<size_t>(image.getWidth()) * static_cast<size_t>(image.getHeight()) * 4 : 0;
+    };
 
-    return frames[static_cast<size_t>(currentFrameIndex)];
+    size_t bytes = deltaFrames != nullptr ? deltaFrames->getResidentBytes() + imageBytes(deltaCanvas) : 0;
+
+    for (const auto& frame : frames)
+        bytes += imageBytes(frame);
+
+    for (const auto& chain : mipLevels)
+        for (const auto& level : chain)
+            bytes += imageBytes(level);
+
+    for (const auto& level : canvasMipLevels)
+        bytes += imageBytes(level);
+
+    for (const auto& frame : filteredFrames)
+        bytes += imageBytes(frame);
+
+    return bytes;
+}
+
+void GifAnimator::resetPlaybackStats()
+{
+    hasSequenceStep = false;
+    droppedFrameChanges = 0;
+}
+
+void GifAnimator::clearFilteredFrames()
+{
+    filteredFrames.clear();
+    filteredFramesFilter = ColorFilterType::None;
+}
+
+void GifAnimator::clearMipLevels()
+{
+    mipLevels.clear();
+    canvasMipLevels.clear();
+    canvasMipFrameIndex = -1;
+}
+
+juce::Image GifAnimator::buildHalfLevel(const juce::Image& source)
+{
+    BOPPER_TRACE_SCOPE("GifAnimator::buildHalfLevel");
+
+    juce::Image half(juce::Image::ARGB,
+                     ImageResampler::halfSize(source.getWidth()),
+                     ImageResampler::halfSize(source.getHeight()),
+                     false);
+
+    juce::Image::BitmapData src(source, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dst(half, juce::Image::BitmapData::writeOnly);
+    ImageResampler::halve(src.data, src.lineStride, src.width, src.height, dst.data, dst.lineStride);
+
+    return half;
 }
@@ -1,52 +1,196 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FrameTimeline.h"
 #include "GifLoader.h"
 #include "Utils/BpmSync.h"
+#include "Utils/ColorFilter.h"
+#include "Utils/MemoryAccountant.h"
+#include <functional>
 #include <vector>
 
-class GifAnimator
+// Decoded frames count against the MemoryAccountant budget. GIFs that don't
+// fit are stored as deltas and downscaled, and mip levels are only built
+// while there is room for them.
+class GifAnimator : private MemoryAccountant::Client
 {
 public:
-    GifAnimator() = default;
+    GifAnimator();
+    ~GifAnimator() override;
 
     // Load a new GIF
     bool loadGif(const juce::File& file);
     bool loadGif(const void* data, size_t size);
+    bool loadGif(juce::InputStream& stream);
 
     // Load frames directly (for programmatic animations)
     void loadFrames(std::vector<juce::Image>&& newFrames);
 
-    // Update animation state based on BPM/PPQ
-    // speedDivisor: 0=1x, 1=1/2, 2=1/4, 3=1/8, 4=1/16
+    // A GIF decoded ahead of time, with its frames optionally run through a
+    // colour filter already. prepare() builds one on any thread; adopt()
+    // switches to it on the message thread without decoding anything.
+    struct PreparedGif
+    {
+        GifLoader::GifData data;
+        juce::File sourceFile;
+        juce::MemoryBlock sourceData;
+        ColorFilterType filter = ColorFilterType::None;
+        std::vector<juce::Image> filteredFrames;
+    };
+
+    // Options to prepare with, read on the message thread. The prepared GIF
+    // is decoded while the current one stays resident, so its frames and
+    // filtered copies are reserved against the memory budget up front and
+    // held until adopt() or cancelPrepare(). nullopt if the budget has no
+    // room for it; load the GIF when it's needed instead.
+    std::optional<GifLoader::LoadOptions> reserveForPrepare(ColorFilterType filter);
+    void cancelPrepare();
+
+    // Decode and pre-filter without touching any animator
+    static std::optional<PreparedGif> prepare(const juce::File& file, const GifLoader::LoadOptions& options,
+                                              ColorFilterType filter);
+    static std::optional<PreparedGif> prepare(const void* data, size_t size, const GifLoader::LoadOptions& options,
+                                              ColorFilterType filter);
+
+    void adopt(PreparedGif&& prepared);
+
+    // Current frame at full size with filter applied, if the GIF was prepared
+    // with that filter; nullptr otherwise
+    const juce::Image* getPrefilteredFrame(ColorFilterType filter) const;
+
+    // Options used by subsequent loadGif calls
+    void setLoadOptions(const GifLoader::LoadOptions& options) { loadOptions = options; }
+
+    // Limit decoded frames to maxDimension pixels on the longest side
+    // (0 = native). Re-decodes the current GIF if its resolution would change.
+    void setMaxDimension(int maxDimension);
+
+    // Update animation state based on BPM/PPQ, one loop per beat
+    // speedDivisor: -2=4x, -1=2x, 0=1x, 1=1/2, 2=1/4, 3=1/8, 4=1/16
     // reverse: play backwards
     // pingPong: play forward then backward
     void update(double bpm, double ppqPosition, bool isPlaying,
                 int speedDivisor = 0, bool reverse = false, bool pingPong = false);
 
+    // Update with a loop mapping built by BpmSync::makeLoopMapping, for bar
+    // and triplet/dotted sync. Build the mapping when its settings change.
+    void update(double ppqPosition, bool isPlaying, const BpmSync::LoopMapping& mapping,
+                bool reverse = false, bool pingPong = false);
+
+    // Show frameIndex now and shift the loop so that frame started at
+    // ppqPosition, as if the loop had been restarted there. The shift holds
+    // for later updates until the next jump.
+    void jumpToFrame(int frameIndex, double ppqPosition, const BpmSync::LoopMapping& mapping,
+                     bool reverse = false, bool pingPong = false);
+
     // Get current frame for display
     const juce::Image& getCurrentFrame() const;
+    int getCurrentFrameIndex() const { return currentFrameIndex; }
+
+    // Current frame at the smallest mip level (full, 1/2, 1/4, ...) that still
+    // covers targetWidth x targetHeight pixels. Levels are built on first use.
+    const juce::Image& getCurrentFrameForSize(int targetWidth, int targetHeight);
 
     // Check if GIF is loaded
-    bool isLoaded() const { return !frames.empty(); }
+    bool isLoaded() const { return getFrameCount() > 0; }
 
     // Get frame count
-    int getFrameCount() const { return static_cast<int>(frames.size()); }
+    int getFrameCount() const;
 
     // Get dimensions
     int getWidth() const { return width; }
     int getHeight() const { return height; }
 
+    // Peak memory used while decoding the current GIF
+    size_t getPeakDecodeBytes() const { return peakDecodeBytes; }
+
+    // Outcome of the last loadGif call
+    GifLoader::LoadStatus getLastLoadStatus() const { return lastLoadStatus; }
+
+    // Bytes held by decoded frames, the delta canvas and mip levels
+    size_t getResidentBytes() const;
+
+    // Frame changes skipped because updates came too slowly, since the last load
+    int getDroppedFrameChanges() const { return droppedFrameChanges; }
+
     // Get current beat phase (0.0 to 1.0) for effects
     double getCurrentBeatPhase() const { return currentBeatPhase; }
 
 private:
+    using Decoder = std::function<std::optional<GifLoader::GifData>(const GifLoader::LoadOptions&,
+                                                                    GifLoader::LoadStatus*)>;
+
+    // Decode within the memory left in the budget, halving the target until it fits
+    std::optional<GifLoader::GifData> decodeWithinBudget(const Decoder& decode);
+    size_t getAvailableBytes() const;
+    static std::optional<GifLoader::GifData> decodeWithRetries(const Decoder& decode, GifLoader::LoadOptions options,
+                                                               GifLoader::LoadStatus& status);
+    static std::optional<PreparedGif> finishPreparing(std::optional<GifLoader::GifData>&& result, ColorFilterType filter);
+
+    size_t releaseCaches() override;
+    void reportResidentBytes();
+
+    void setLoadedData(GifLoader::GifData&& data);
+    void setFrameIndex(int index);
+    bool reloadFromSource();
+    void clearMipLevels();
+    void clearFilteredFrames();
+    void resetPlaybackStats();
+    static juce::Image buildHalfLevel(const juce::Image& source);
+
+    GifLoader::LoadOptions loadOptions;
+
+    // Source of the current GIF, kept so it can be re-decoded at another size
+    juce::File sourceFile;
+    juce::MemoryBlock sourceData;
+    int sourceWidth = 0;
+    int sourceHeight = 0;
+    size_t peakDecodeBytes = 0;
+
+    // Bytes held for a GIF being prepared, reported along with the resident ones
+    size_t prepareReservation = 0;
+
+    GifLoader::LoadStatus lastLoadStatus = GifLoader::LoadStatus::Ok;
+
     std::vector<juce::Image> frames;
+
+    // Beat position to frame mapping, weighted by the GIF's frame delays
+    FrameTimeline timeline;
+
+    // Keyframe + delta storage; frames are rebuilt into deltaCanvas on demand
+    std::unique_ptr<DeltaFrameStore> deltaFrames;
+    juce::Image deltaCanvas;
+    int deltaCanvasFrameIndex = -1;
+
+    // Full-size frames with a colour filter applied, from adopt(). Dropped
+    // under memory pressure; the display filters live without them.
+    std::vector<juce::Image> filteredFrames;
+    ColorFilterType filteredFramesFilter = ColorFilterType::None;
+
+    // Lazily built mip levels per frame, starting at 1/2 size
+    std::vector<std::vector<juce::Image>> mipLevels;
+
+    // Mip levels of deltaCanvas, valid only for the frame they were built from
+    std::vector<juce::Image> canvasMipLevels;
+    int canvasMipFrameIndex = -1;
+
     int currentFrameIndex = 0;
+
+    // Loops subtracted from the mapping's position, set by jumpToFrame and
+    // cleared when another GIF loads
+    double loopOffset = 0.0;
+
+    // Position in the unfolded frame sequence at the last update, for counting skips
+    juce::int64 lastSequenceStep = 0;
+    bool hasSequenceStep = false;
+    int droppedFrameChanges = 0;
+
     int width = 0;
     int height = 0;
     double currentBeatPhase = 0.0;
 
     // Fallback blank image
     juce::Image blankImage{juce::Image::ARGB, 1, 1, true};
+
+    JUCE_DECLARE_NON_COPYABLE(GifAnimator)
 };
@@ -1,105 +1,474 @@
 #include "GifLoader.h"
+#include "ImageResampler.h"
+#include "Utils/TraceRecorder.h"
 #include "EasyGifReader/EasyGifReader.h"
 
-std::optional<GifLoader::GifData> GifLoader::loadFromFile(const juce::File& file)
+namespace
 {
-    if (!file.existsAsFile())
-        return std::nullopt;
+    using PixelComponent = EasyGifReader::PixelComponent;
 
-    return loadGifInternal(file.getFullPathName().toStdString());
-}
+    // Reads through giflib arrive in small chunks, so file-like streams are buffered
+    constexpr int streamBufferSize = 64 * 1024;
 
-std::optional<GifLoader::GifData> GifLoader::loadFromMemory(const void* data, size_t size)
-{
-    return loadGifFromMemoryInternal(data, size);
-}
+    struct ReadContext
+    {
+        juce::InputStream* stream = nullptr;
+        double deadlineMs = 0.0; // Time::getMillisecondCounterHiRes() value, 0 = none
+        bool timedOut = false;
+    };
 
-std::optional<GifLoader::GifData> GifLoader::loadGifInternal(const std::string& filePath)
-{
-    try
+    bool isPastDeadline(double deadlineMs)
+    {
+        return deadlineMs > 0.0 && juce::Time::getMillisecondCounterHiRes() > deadlineMs;
+    }
+
+    size_t readFromStream(void* outData, size_t size, void* userPtr)
+    {
+        auto* context = static_cast<ReadContext*>(userPtr);
+
+        // Failing the read makes giflib give up on a slurp that takes too long
+        if (isPastDeadline(context->deadlineMs))
+        {
+            context->timedOut = true;
+            return 0;
+        }
+
+        int bytesRead = context->stream->read(outData, static_cast<int>(size));
+        return bytesRead > 0 ? static_cast<size_t>(bytesRead) : 0;
+    }
+
+    bool skipSubBlocks(juce::InputStream& stream)
+    {
+        for (;;)
+        {
+            if (stream.isExhausted())
+                return false;
+
+            int length = static_cast<uint8_t>(stream.readByte());
+            if (length == 0)
+                return true;
+
+            stream.skipNextBytes(length);
+        }
+    }
+
+    // Walk the GIF's block structure without decoding anything, so oversized
+    // canvases, frame floods and LZW bombs are rejected before giflib
+    // allocates a raster for every frame
+    GifLoader::LoadStatus scanBlocks(juce::InputStream& stream, const GifLoader::LoadOptions& options)
     {
-        EasyGifReader gif = EasyGifReader::openFile(filePath.c_str());
+        using Status = GifLoader::LoadStatus;
+
+        char signature[6] = {};
+        if (stream.read(signature, 6) != 6 || std::memcmp(signature, "GIF", 3) != 0)
+            return Status::InvalidGif;
 
-        GifData data;
-        data.width = gif.width();
-        data.height = gif.height();
+        const juce::int64 canvasWidth = static_cast<uint16_t>(stream.readShort());
+        const juce::int64 canvasHeight = static_cast<uint16_t>(stream.readShort());
+        const auto flags = static_cast<uint8_t>(stream.readByte());
+        stream.skipNextBytes(2); // background colour, aspect ratio
 
-        for (const auto& frame : gif)
+        if (flags & 0x80)
+            stream.skipNextBytes(3 << ((flags & 7) + 1));
+
+        const juce::int64 canvasPixels = canvasWidth * canvasHeight;
+        if (options.maxCanvasPixels > 0 && canvasPixels > options.maxCanvasPixels)
+            return Status::TooLarge;
+
+        // giflib keeps one byte per pixel of every frame, plus RGBA canvases
+        const auto maxDecodeBytes = static_cast<juce::int64>(options.maxDecodeBytes);
+        juce::int64 decodeBytes = canvasPixels * 4 * 2;
+        int frameCount = 0;
+
+        while (!stream.isExhausted())
         {
-            juce::Image img(juce::Image::ARGB, data.width, data.height, true);
-            const EasyGifReader::PixelComponent* src = frame.pixels();
+            const auto blockType = static_cast<uint8_t>(stream.readByte());
+
+            if (blockType == 0x3b) // trailer
+                break;
+
+            if (blockType == 0x21) // extension
+            {
+                stream.skipNextBytes(1);
+                if (!skipSubBlocks(stream))
+                    break;
+            }
+            else if (blockType == 0x2c) // image
+            {
+                stream.skipNextBytes(4); // left, top
+                const juce::int64 frameWidth = static_cast<uint16_t>(stream.readShort());
+                const juce::int64 frameHeight = static_cast<uint16_t>(stream.readShort());
+                const auto frameFlags = static_cast<uint8_t>(stream.readByte());
+
+                if (frameFlags & 0x80)
+                    stream.skipNextBytes(3 << ((frameFlags & 7) + 1));
+
+                stream.skipNextBytes(1); // LZW minimum code size
+                if (!skipSubBlocks(stream))
+                    break;
 
-            juce::Image::BitmapData bitmap(img, juce::Image::BitmapData::writeOnly);
+                const juce::int64 framePixels = frameWidth * frameHeight;
+                if (options.maxCanvasPixels > 0 && framePixels > options.maxCanvasPixels)
+                    return Status::TooLarge;
 
-            for (int y = 0; y < data.height; ++y)
+                if (options.maxFrameCount > 0 && ++frameCount > options.maxFrameCount)
+                    return Status::TooManyFrames;
+
+                decodeBytes += framePixels;
+                if (maxDecodeBytes > 0 && decodeBytes > maxDecodeBytes)
+                    return Status::TooLarge;
+            }
+            else
             {
-                for (int x = 0; x < data.width; ++x)
+                // Unknown block: leave the error to giflib
+                break;
+            }
+        }
+
+        return Status::Ok;
+    }
+
+    // Convert an area of a straight-alpha RGBA canvas into a premultiplied ARGB image
+    juce::Image convertRegion(const PixelComponent* src, int canvasWidth, juce::Rectangle<int> area)
+    {
+        juce::Image img(juce::Image::ARGB, area.getWidth(), area.getHeight(), false);
+        juce::Image::BitmapData bitmap(img, juce::Image::BitmapData::writeOnly);
+        jassert(bitmap.pixelFormat == juce::Image::ARGB && bitmap.pixelStride == 4);
+
+        for (int y = 0; y < area.getHeight(); ++y)
+        {
+            const PixelComponent* s = src + (static_cast<size_t>(area.getY() + y) * static_cast<size_t>(canvasWidth)
+                                              + static_cast<size_t>(area.getX())) * 4;
+            auto* d = reinterpret_cast<juce::PixelARGB*>(bitmap.getLinePointer(y));
+
+            for (int x = 0; x < area.getWidth(); ++x, s += 4, ++d)
+            {
+                const uint8_t a = s[3];
+
+                // Decoded GIF pixels are either opaque or fully transparent;
+                // only downscaled edges need a real premultiply
+                if (a == 0)
+                {
+                    d->setARGB(0, 0, 0, 0);
+                }
+                else
                 {
-                    int srcIdx = (y * data.width + x) * 4;
-                    uint8_t r = src[srcIdx + 0];
-                    uint8_t g = src[srcIdx + 1];
-                    uint8_t b = src[srcIdx + 2];
-                    uint8_t a = src[srcIdx + 3];
+                    d->setARGB(a, s[0], s[1], s[2]);
+                    if (a != 255)
+                        d->premultiply();
+                }
+            }
+        }
+
+        return img;
+    }
+
+    // Bounding box of the pixels that differ between two RGBA canvases
+    juce::Rectangle<int> findChangedArea(const PixelComponent* previous, const PixelComponent* current,
+                                         int width, int height)
+    {
+        const size_t rowBytes = static_cast<size_t>(width) * 4;
+        auto rowsDiffer = [&](int y)
+        {
+            return std::memcmp(previous + y * rowBytes, current + y * rowBytes, rowBytes) != 0;
+        };
+
+        int top = 0;
+        while (top < height && !rowsDiffer(top))
+            ++top;
+
+        if (top == height)
+            return {};
 
-                    bitmap.setPixelColour(x, y, juce::Colour(r, g, b, a));
+        int bottom = height;
+        while (!rowsDiffer(bottom - 1))
+            --bottom;
+
+        int left = width;
+        int right = 0;
+        for (int y = top; y < bottom; ++y)
+        {
+            const PixelComponent* prevRow = previous + y * rowBytes;
+            const PixelComponent* curRow = current + y * rowBytes;
+
+            for (int x = 0; x < left; ++x)
+            {
+                if (std::memcmp(prevRow + x * 4, curRow + x * 4, 4) != 0)
+                {
+                    left = x;
+                    break;
+                }
+            }
+
+            for (int x = width - 1; x >= right; --x)
+            {
+                if (std::memcmp(prevRow + x * 4, curRow + x * 4, 4) != 0)
+                {
+                    right = x + 1;
+                    break;
                 }
             }
+        }
+
+        return juce::Rectangle<int>::leftTopRightBottom(left, top, right, bottom);
+    }
+}
+
+juce::String GifLoader::describe(LoadStatus status)
+{
+    switch (status)
+    {
+        case LoadStatus::Ok:            return {};
+        case LoadStatus::ReadError:     return "The file could not be read";
+        case LoadStatus::InvalidGif:    return "Not a valid GIF";
+        case LoadStatus::OverBudget:    return "The GIF does not fit in the memory budget";
+        case LoadStatus::TooLarge:      return "The GIF is too large to decode";
+        case LoadStatus::TooManyFrames: return "The GIF has too many frames";
+        case LoadStatus::TimedOut:      return "Decoding the GIF took too long";
+    }
+    return {};
+}
 
-            data.frames.push_back(std::move(img));
+std::optional<GifLoader::GifData> GifLoader::loadFromFile(const juce::File& file, const LoadOptions& options,
+                                                          LoadStatus* status)
+{
+    std::unique_ptr<juce::FileInputStream> stream;
+    if (file.existsAsFile())
+        stream = file.createInputStream();
+
+    if (stream == nullptr || stream->failedToOpen())
+    {
+        if (status != nullptr)
+            *status = LoadStatus::ReadError;
+        return std::nullopt;
+    }
+
+    return loadFromStream(*stream, options, status);
+}
+
+std::optional<GifLoader::GifData> GifLoader::loadFromMemory(const void* data, size_t size, const LoadOptions& options,
+                                                            LoadStatus* status)
+{
+    juce::MemoryInputStream stream(data, size, false);
+    return loadFromStream(stream, options, status);
+}
+
+std::optional<GifLoader::GifData> GifLoader::loadFromStream(juce::InputStream& stream, const LoadOptions& options,
+                                                            LoadStatus* status)
+{
+    LoadStatus result = LoadStatus::InvalidGif;
+
+    // Memory streams already serve any read size cheaply
+    std::unique_ptr<juce::InputStream> buffered;
+    juce::InputStream* source = &stream;
+
+    if (dynamic_cast<juce::MemoryInputStream*>(&stream) == nullptr)
+    {
+        buffered = std::make_unique<juce::BufferedInputStream>(&stream, streamBufferSize, false);
+        source = buffered.get();
+    }
+
+    ReadContext context;
+    context.stream = source;
+    if (options.maxDecodeMilliseconds > 0)
+        context.deadlineMs = juce::Time::getMillisecondCounterHiRes() + options.maxDecodeMilliseconds;
+
+    auto finish = [status](LoadStatus outcome)
+    {
+        if (status != nullptr)
+            *status = outcome;
+    };
+
+    {
+        BOPPER_TRACE_SCOPE("GifLoader::scan");
+        const auto start = source->getPosition();
+        result = scanBlocks(*source, options);
+
+        if (result != LoadStatus::Ok)
+        {
+            finish(result);
+            return std::nullopt;
         }
 
-        if (data.frames.empty())
+        if (!source->setPosition(start))
+        {
+            finish(LoadStatus::ReadError);
             return std::nullopt;
+        }
+    }
 
+    try
+    {
+        BOPPER_TRACE_SCOPE("GifLoader::load");
+        EasyGifReader gif = [&]
+        {
+            BOPPER_TRACE_SCOPE("GifLoader::open");
+            return EasyGifReader::openCustom(&readFromStream, &context);
+        }();
+        auto data = decodeFrames(gif, options, context.deadlineMs, result);
+        finish(result);
         return data;
     }
     catch (...)
     {
+        finish(context.timedOut ? LoadStatus::TimedOut : LoadStatus::InvalidGif);
         return std::nullopt;
     }
 }
 
-std::optional<GifLoader::GifData> GifLoader::loadGifFromMemoryInternal(const void* data, size_t size)
+std::optional<GifLoader::GifData> GifLoader::decodeFrames(EasyGifReader& gif, const LoadOptions& options,
+                                                          double deadlineMs, LoadStatus& status)
 {
-    try
+    GifData data;
+    data.sourceWidth = gif.width();
+    data.sourceHeight = gif.height();
+    data.width = data.sourceWidth;
+    data.height = data.sourceHeight;
+    ImageResampler::fitWithin(data.width, data.height, options.maxDimension);
+
+    const int frameCount = gif.frameCount();
+    int keyframeInterval = options.keyframeInterval;
+
+    if (options.byteBudget > 0)
     {
-        EasyGifReader gif = EasyGifReader::openMemory(data, size);
+        // Rough resident size: full frames, or keyframes plus deltas that
+        // typically cover about a quarter of the canvas
+        auto estimateBytes = [&](int w, int h)
+        {
+            const double canvas = static_cast<double>(w) * static_cast<double>(h) * 4.0;
+            if (keyframeInterval <= 0)
+                return canvas * frameCount;
+
+            const double keyframes = std::ceil(frameCount / static_cast<double>(keyframeInterval));
+            return canvas * (keyframes + (frameCount - keyframes) * 0.25);
+        };
 
-        GifData gifData;
-        gifData.width = gif.width();
-        gifData.height = gif.height();
+        const auto budget = static_cast<double>(options.byteBudget);
 
-        for (const auto& frame : gif)
+        if (keyframeInterval <= 0 && estimateBytes(data.width, data.height) > budget)
+            keyframeInterval = budgetKeyframeInterval;
+
+        double estimate = estimateBytes(data.width, data.height);
+        if (estimate > budget)
         {
-            juce::Image img(juce::Image::ARGB, gifData.width, gifData.height, true);
-            const EasyGifReader::PixelComponent* src = frame.pixels();
+            const double scale = std::sqrt(budget / estimate);
+            const int longestSide = std::max(data.width, data.height);
+            ImageResampler::fitWithin(data.width, data.height,
+                                      std::max(1, static_cast<int>(longestSide * scale)));
+        }
+    }
 
-            juce::Image::BitmapData bitmap(img, juce::Image::BitmapData::writeOnly);
+    const juce::Rectangle<int> canvasArea(data.width, data.height);
+    const size_t canvasBytes = static_cast<size_t>(data.width) * static_cast<size_t>(data.height) * 4;
+    const bool useDeltas = keyframeInterval > 0;
+    const bool downscale = data.width != data.sourceWidth || data.height != data.sourceHeight;
 
-            for (int y = 0; y < gifData.height; ++y)
-            {
-                for (int x = 0; x < gifData.width; ++x)
-                {
-                    int srcIdx = (y * gifData.width + x) * 4;
-                    uint8_t r = src[srcIdx + 0];
-                    uint8_t g = src[srcIdx + 1];
-                    uint8_t b = src[srcIdx + 2];
-                    uint8_t a = src[srcIdx + 3];
+    // Previous canvas, kept only to find what changed between frames
+    std::vector<PixelComponent> previousCanvas;
 
-                    bitmap.setPixelColour(x, y, juce::Colour(r, g, b, a));
-                }
+    // Downscaled copy of the decoder's canvas, and the filter state that
+    // produces it, reused for every frame
+    std::vector<PixelComponent> scaledCanvas;
+    std::optional<ImageResampler::DownscaleWorkspace> downscaleWorkspace;
+
+    if (useDeltas)
+    {
+        data.deltaFrames = std::make_unique<DeltaFrameStore>(data.width, data.height, keyframeInterval);
+        previousCanvas.resize(canvasBytes);
+    }
+
+    if (downscale)
+    {
+        scaledCanvas.resize(canvasBytes);
+        downscaleWorkspace.emplace(data.sourceWidth, data.sourceHeight, data.width, data.height);
+    }
+
+    const size_t scratchBytes = previousCanvas.size() + scaledCanvas.size()
+                              + (downscaleWorkspace.has_value() ? downscaleWorkspace->getBytes() : 0);
+    size_t convertedBytes = 0;
+    data.frameDurationsMs.reserve(static_cast<size_t>(frameCount));
+
+    auto frame = gif.begin();
+
+    for (int frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+    {
+        // Advance only while frames remain: stepping past the last frame of a
+        // looping GIF would composite frame 0 again, after its data is released
+        {
+            BOPPER_TRACE_SCOPE("GifLoader::composite");
+            if (frameIndex > 0)
+                ++frame;
+        }
+
+        const PixelComponent* src = frame->pixels();
+        data.frameDurationsMs.push_back(frame->duration().milliseconds());
+
+        // Everything is resident right after compositing, before this frame's
+        // index data is released
+        data.peakDecodeBytes = std::max(data.peakDecodeBytes, gif.residentBytes() + scratchBytes + convertedBytes);
+        gif.releaseFrameData(frameIndex);
+
+        if (downscale)
+        {
+            BOPPER_TRACE_SCOPE("GifLoader::downscale");
+            ImageResampler::downscaleRGBA(src, scaledCanvas.data(), *downscaleWorkspace);
+            src = scaledCanvas.data();
+        }
+
+        BOPPER_TRACE_SCOPE("GifLoader::convert");
+
+        if (!useDeltas)
+        {
+            data.frames.push_back(convertRegion(src, data.width, canvasArea));
+            convertedBytes += canvasBytes;
+        }
+        else
+        {
+            auto& store = *data.deltaFrames;
+            if (store.isKeyframeIndex(store.getFrameCount()))
+            {
+                store.addKeyframe(convertRegion(src, data.width, canvasArea));
+            }
+            else
+            {
+                auto changed = findChangedArea(previousCanvas.data(), src, data.width, data.height);
+                if (changed.isEmpty())
+                    store.addDelta({}, {});
+                else
+                    store.addDelta(convertRegion(src, data.width, changed), changed.getPosition());
             }
 
-            gifData.frames.push_back(std::move(img));
+            convertedBytes = store.getResidentBytes();
+            std::memcpy(previousCanvas.data(), src, previousCanvas.size());
         }
 
-        if (gifData.frames.empty())
+        if (options.byteBudget > 0 && convertedBytes > options.byteBudget)
+        {
+            status = LoadStatus::OverBudget;
             return std::nullopt;
+        }
 
-        return gifData;
+        if (options.maxDecodeBytes > 0 && data.peakDecodeBytes > options.maxDecodeBytes)
+        {
+            status = LoadStatus::TooLarge;
+            return std::nullopt;
+        }
+
+        if (isPastDeadline(deadlineMs))
+        {
+            status = LoadStatus::TimedOut;
+            return std::nullopt;
+        }
     }
-    catch (...)
+
+    data.peakDecodeBytes = std::max(data.peakDecodeBytes, gif.residentBytes() + scratchBytes + convertedBytes);
+
+    if (data.frames.empty() && (data.deltaFrames == nullptr || data.deltaFrames->getFrameCount() == 0))
     {
+        status = LoadStatus::InvalidGif;
         return std::nullopt;
     }
+
+    status = LoadStatus::Ok;
+    return data;
 }
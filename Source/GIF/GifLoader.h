@@ -1,26 +1,90 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DeltaFrameStore.h"
 #include <vector>
 #include <optional>
+#include <memory>
+
+class EasyGifReader;
 
 class GifLoader
 {
 public:
+    struct LoadOptions
+    {
+        // Store a full keyframe every N frames and only changed rectangles in
+        // between (0 = store every frame in full)
+        int keyframeInterval = 0;
+
+        // Downscale frames during decode so the longest side is at most this
+        // many pixels (0 = keep native resolution)
+        int maxDimension = 0;
+
+        // Most bytes the decoded frames may occupy (0 = unlimited). GIFs that
+        // would not fit are stored as deltas and downscaled until they should;
+        // if they still outgrow it while decoding, the load fails with OverBudget.
+        size_t byteBudget = 0;
+
+        // Guards against broken or hostile files, checked before giflib
+        // allocates anything and while decoding (0 = no limit)
+        juce::int64 maxCanvasPixels = juce::int64(8192) * 8192;
+        int maxFrameCount = 4096;
+        size_t maxDecodeBytes = size_t(1024) * 1024 * 1024;
+        int maxDecodeMilliseconds = 5000;
+    };
+
+    enum class LoadStatus
+    {
+        Ok,
+        ReadError,
+        InvalidGif,
+        OverBudget,
+        TooLarge,
+        TooManyFrames,
+        TimedOut
+    };
+
+    // Message for the UI
+    static juce::String describe(LoadStatus status);
+
     struct GifData
     {
+        // Full frames, empty when deltaFrames is used instead
         std::vector<juce::Image> frames;
+        std::unique_ptr<DeltaFrameStore> deltaFrames;
         int width = 0;
         int height = 0;
+
+        // Delay of each frame in milliseconds, as stored in the file
+        std::vector<int> frameDurationsMs;
+
+        // Resolution stored in the file, before any downscaling
+        int sourceWidth = 0;
+        int sourceHeight = 0;
+
+        // Highest number of bytes held at once while decoding (decoder state,
+        // scratch canvases, downscale buffers and converted frames)
+        size_t peakDecodeBytes = 0;
     };
 
     // Load GIF from file path
-    static std::optional<GifData> loadFromFile(const juce::File& file);
+    static std::optional<GifData> loadFromFile(const juce::File& file, const LoadOptions& options = {},
+                                               LoadStatus* status = nullptr);
 
     // Load GIF from memory (for embedded presets)
-    static std::optional<GifData> loadFromMemory(const void* data, size_t size);
+    static std::optional<GifData> loadFromMemory(const void* data, size_t size, const LoadOptions& options = {},
+                                                 LoadStatus* status = nullptr);
+
+    // Load GIF from any stream (files, memory, zip entries, ...).
+    // The stream is read from its current position.
+    static std::optional<GifData> loadFromStream(juce::InputStream& stream, const LoadOptions& options = {},
+                                                 LoadStatus* status = nullptr);
+
+    // Keyframe interval used when a GIF has to be stored as deltas to fit its budget
+    static constexpr int budgetKeyframeInterval = 8;
 
 private:
-    static std::optional<GifData> loadGifInternal(const std::string& filePath);
-    static std::optional<GifData> loadGifFromMemoryInternal(const void* data, size_t size);
+    static std::optional<GifData> decodeFrames(EasyGifReader& gif, const LoadOptions& options,
+                                               double deadlineMs, LoadStatus& status);
 };
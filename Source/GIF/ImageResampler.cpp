@@ -0,0 +1,211 @@
+#include "ImageResampler.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define BOPPER_HALVE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define BOPPER_HALVE_NEON 1
+#endif
+
+void ImageResampler::fitWithin(int& width, int& height, int maxDimension)
+{
+    const int longest = std::max(width, height);
+    if (maxDimension <= 0 || longest <= maxDimension)
+        return;
+
+    const double scale = static_cast<double>(maxDimension) / static_cast<double>(longest);
+    width = std::max(1, static_cast<int>(std::lround(width * scale)));
+    height = std::max(1, static_cast<int>(std::lround(height * scale)));
+}
+
+ImageResampler::DownscaleWorkspace::DownscaleWorkspace(int srcWidthIn, int srcHeightIn, int dstWidthIn, int dstHeightIn)
+    : srcWidth(srcWidthIn), srcHeight(srcHeightIn), dstWidth(dstWidthIn), dstHeight(dstHeightIn)
+{
+    addSpans(columns, srcWidth, dstWidth);
+    addSpans(rows, srcHeight, dstHeight);
+    horizontal.resize(static_cast<size_t>(dstWidth) * static_cast<size_t>(srcHeight) * 4);
+    accum.resize(static_cast<size_t>(dstWidth) * 4);
+}
+
+void ImageResampler::DownscaleWorkspace::addSpans(std::vector<Span>& spans, int srcSize, int dstSize)
+{
+    spans.resize(static_cast<size_t>(std::max(dstSize, 0)));
+    const double scale = static_cast<double>(srcSize) / static_cast<double>(dstSize);
+
+    for (int d = 0; d < dstSize; ++d)
+    {
+        const double start = d * scale;
+        const double end = std::min(static_cast<double>(srcSize), (d + 1) * scale);
+        auto& span = spans[static_cast<size_t>(d)];
+        span.first = static_cast<int>(start);
+        span.weightsStart = weights.size();
+
+        for (int s = span.first; s < end; ++s)
+        {
+            double coverage = std::min(end, s + 1.0) - std::max(start, static_cast<double>(s));
+            weights.push_back(static_cast<float>(coverage / scale));
+        }
+
+        span.count = static_cast<int>(weights.size() - span.weightsStart);
+    }
+}
+
+size_t ImageResampler::DownscaleWorkspace::getBytes() const
+{
+    return (columns.capacity() + rows.capacity()) * sizeof(Span)
+         + (weights.capacity() + horizontal.capacity() + accum.capacity()) * sizeof(float);
+}
+
+void ImageResampler::downscaleRGBA(const uint8_t* src, uint8_t* dst, DownscaleWorkspace& workspace)
+{
+    const int srcWidth = workspace.srcWidth;
+    const int srcHeight = workspace.srcHeight;
+    const int dstWidth = workspace.dstWidth;
+    const int dstHeight = workspace.dstHeight;
+    const float* weights = workspace.weights.data();
+    auto& horizontal = workspace.horizontal;
+    auto& accum = workspace.accum;
+
+    // Horizontal pass into premultiplied float rows
+    for (int y = 0; y < srcHeight; ++y)
+    {
+        const uint8_t* srcRow = src + static_cast<size_t>(y) * static_cast<size_t>(srcWidth) * 4;
+        float* out = horizontal.data() + static_cast<size_t>(y) * static_cast<size_t>(dstWidth) * 4;
+
+        for (const auto& span : workspace.columns)
+        {
+            float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+            const uint8_t* px = srcRow + span.first * 4;
+            const float* w = weights + span.weightsStart;
+
+            for (int i = 0; i < span.count; ++i)
+            {
+                float wa = w[i] * px[3];
+                r += wa * px[0];
+                g += wa * px[1];
+                b += wa * px[2];
+                a += wa;
+                px += 4;
+            }
+
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            out[3] = a;
+            out += 4;
+        }
+    }
+
+    // Vertical pass, then back to straight alpha
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        const auto& span = workspace.rows[static_cast<size_t>(y)];
+        std::fill(accum.begin(), accum.end(), 0.0f);
+
+        for (int i = 0; i < span.count; ++i)
+        {
+            const float w = weights[span.weightsStart + static_cast<size_t>(i)];
+            const float* in = horizontal.data() + static_cast<size_t>(span.first + i) * static_cast<size_t>(dstWidth) * 4;
+
+            for (size_t k = 0; k < accum.size(); ++k)
+                accum[k] += w * in[k];
+        }
+
+        uint8_t* out = dst + static_cast<size_t>(y) * static_cast<size_t>(dstWidth) * 4;
+
+        for (int x = 0; x < dstWidth; ++x)
+        {
+            const float* px = accum.data() + x * 4;
+            const float a = px[3];
+
+            if (a < 0.5f)
+            {
+                out[0] = out[1] = out[2] = out[3] = 0;
+            }
+            else
+            {
+                out[0] = static_cast<uint8_t>(std::min(255.0f, px[0] / a + 0.5f));
+                out[1] = static_cast<uint8_t>(std::min(255.0f, px[1] / a + 0.5f));
+                out[2] = static_cast<uint8_t>(std::min(255.0f, px[2] / a + 0.5f));
+                out[3] = static_cast<uint8_t>(std::min(255.0f, a + 0.5f));
+            }
+
+            out += 4;
+        }
+    }
+}
+
+void ImageResampler::halve(const uint8_t* src, int srcStride, int width, int height,
+                           uint8_t* dst, int dstStride)
+{
+    const int dstWidth = halfSize(width);
+    const int dstHeight = halfSize(height);
+
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        const uint8_t* row0 = src + static_cast<size_t>(std::min(2 * y, height - 1)) * static_cast<size_t>(srcStride);
+        const uint8_t* row1 = src + static_cast<size_t>(std::min(2 * y + 1, height - 1)) * static_cast<size_t>(srcStride);
+        uint8_t* out = dst + static_cast<size_t>(y) * static_cast<size_t>(dstStride);
+        int x = 0;
+
+        // Vector paths produce 4 output pixels from 8 input pixels per row
+        const int vectorWidth = width >= 2 ? (width / 8) * 4 : 0;
+
+       #if BOPPER_HALVE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i two = _mm_set1_epi16(2);
+
+        for (; x < vectorWidth; x += 4)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+            // Vertical sums, two pixels per register
+            __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(c, zero));
+            __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(c, zero));
+            __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(d, zero));
+            __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(d, zero));
+
+            // Horizontal sums of neighbouring pixels, then round and divide by 4
+            __m128i t0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+            __m128i t1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+            t0 = _mm_srli_epi16(_mm_add_epi16(t0, two), 2);
+            t1 = _mm_srli_epi16(_mm_add_epi16(t1, two), 2);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(t0, t1));
+        }
+       #elif BOPPER_HALVE_NEON
+        for (; x < vectorWidth; x += 4)
+        {
+            // De-interleave into even and odd pixels
+            uint32x4x2_t r0 = vld2q_u32(reinterpret_cast<const uint32_t*>(row0 + x * 8));
+            uint32x4x2_t r1 = vld2q_u32(reinterpret_cast<const uint32_t*>(row1 + x * 8));
+            uint8x16_t e0 = vreinterpretq_u8_u32(r0.val[0]);
+            uint8x16_t o0 = vreinterpretq_u8_u32(r0.val[1]);
+            uint8x16_t e1 = vreinterpretq_u8_u32(r1.val[0]);
+            uint8x16_t o1 = vreinterpretq_u8_u32(r1.val[1]);
+
+            uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(e0), vget_low_u8(o0)),
+                                      vaddl_u8(vget_low_u8(e1), vget_low_u8(o1)));
+            uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(e0), vget_high_u8(o0)),
+                                      vaddl_u8(vget_high_u8(e1), vget_high_u8(o1)));
+
+            vst1q_u8(out + x * 4, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+        }
+       #endif
+
+        for (; x < dstWidth; ++x)
+        {
+            const int x0 = std::min(2 * x, width - 1) * 4;
+            const int x1 = std::min(2 * x + 1, width - 1) * 4;
+
+            for (int k = 0; k < 4; ++k)
+                out[x * 4 + k] = static_cast<uint8_t>((row0[x0 + k] + row0[x1 + k] + row1[x0 + k] + row1[x1 + k] + 2) >> 2);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ImageResampler
+{
+public:
+    // Scale (width, height) down so the longest side fits maxDimension,
+    // keeping aspect ratio. maxDimension <= 0 leaves the size unchanged.
+    static void fitWithin(int& width, int& height, int maxDimension);
+
+    // Filter spans and scratch rows for downscaling from one size to another.
+    // Built once per GIF, so downscaling each frame allocates nothing.
+    class DownscaleWorkspace
+    {
+    public:
+        DownscaleWorkspace(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+
+        // Bytes held by the spans and scratch rows
+        size_t getBytes() const;
+
+    private:
+        friend class ImageResampler;
+
+        // Source span of one destination pixel along an axis, and where its
+        // coverage weights start in weights
+        struct Span
+        {
+            int first = 0;
+            int count = 0;
+            size_t weightsStart = 0;
+        };
+
+        void addSpans(std::vector<Span>& spans, int srcSize, int dstSize);
+
+        int srcWidth = 0;
+        int srcHeight = 0;
+        int dstWidth = 0;
+        int dstHeight = 0;
+        std::vector<Span> columns;
+        std::vector<Span> rows;
+        std::vector<float> weights;
+        std::vector<float> horizontal; // Horizontal pass, dstWidth x srcHeight premultiplied floats
+        std::vector<float> accum;      // One destination row of the vertical pass
+    };
+
+    // Area-averaging (box filter) downscale of a straight-alpha RGBA buffer,
+    // between the sizes the workspace was built for. Colours are weighted by
+    // alpha so transparent pixels don't bleed in. The destination must not be
+    // larger than the source in either dimension.
+    static void downscaleRGBA(const uint8_t* src, uint8_t* dst, DownscaleWorkspace& workspace);
+
+    // Size of the next mip level (half, rounded down, never below 1)
+    static int halfSize(int size) { return size > 1 ? size / 2 : 1; }
+
+    // 2x2 box filter of a 4-byte-per-pixel premultiplied buffer into one of
+    // halfSize(width) x halfSize(height). Strides are in bytes.
+    // Uses SSE2 or NEON where available.
+    static void halve(const uint8_t* src, int srcStride, int width, int height,
+                      uint8_t* dst, int dstStride);
+};
@@ -1,15 +1,20 @@
 #include "PluginEditor.h"
 #include "BinaryData.h"
+#include "Utils/TraceRecorder.h"
 
 BopperAudioProcessorEditor::BopperAudioProcessorEditor(BopperAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p)
 {
     setLookAndFeel(&lookAndFeel);
 
+    // Visual controls are attached to the processor's host parameters
+    auto& parameters = audioProcessor.getParameters();
+
     // Title - thin futuristic font
     titleLabel.setText("BOPPER", juce::dontSendNotification);
     titleLabel.setFont(BopperLookAndFeel::getTechFont(22.0f));
     titleLabel.setColour(juce::Label::textColourId, BopperLookAndFeel::Colors::text);
+    titleLabel.addMouseListener(this, false); // Right-click opens the diagnostics menu
     addAndMakeVisible(titleLabel);
 
     // BPM display - thin futuristic font
@@ -19,17 +24,43 @@ BopperAudioProcessorEditor::BopperAudioProcessorEditor(BopperAudioProcessor& p)
     bpmLabel.setJustificationType(juce::Justification::centredRight);
     addAndMakeVisible(bpmLabel);
 
-    // Speed slider (0-4 for Normal, Slow, Slower, Even Slower, Slowest)
-    speedSlider.setRange(0, 4, 1);
-    speedSlider.setValue(audioProcessor.getSpeedDivisor());
+    // Standalone has no host transport: play/stop and a tempo to play at
+    hasInternalTransport = audioProcessor.wrapperType == juce::AudioProcessor::wrapperType_Standalone;
+    if (hasInternalTransport)
+    {
+        bpmLabel.setEditable(false, true);
+        bpmLabel.onEditorShow = [this]()
+        {
+            if (auto* editor = bpmLabel.getCurrentTextEditor())
+            {
+                editor->setText(juce::String(audioProcessor.getInternalBpm(), 1), false);
+                editor->selectAll();
+            }
+        };
+        bpmLabel.onTextChange = [this]()
+        {
+            const double bpm = bpmLabel.getText().retainCharacters("0123456789.").getDoubleValue();
+            if (bpm > 0.0)
+                audioProcessor.setInternalBpm(bpm);
+        };
+
+        playButton.setButtonText("PLAY");
+        playButton.setClickingTogglesState(true);
+        playButton.setToggleState(audioProcessor.isInternalClockPlaying(), juce::dontSendNotification);
+        playButton.onClick = [this]()
+        {
+            audioProcessor.setInternalClockPlaying(playButton.getToggleState());
+        };
+        addAndMakeVisible(playButton);
+    }
+
+    // Speed slider (-2 to 4 for 4x, 2x, Normal, Slow, Slower, Even Slower, Slowest)
+    // The range and value come from the speed parameter
     speedSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     speedSlider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
-    speedSlider.onValueChange = [this]()
-    {
-        int divisor = static_cast<int>(speedSlider.getValue());
-        audioProcessor.setSpeedDivisor(divisor);
-        updateSpeedLabel();
-    };
+    speedSlider.setName("Speed");
+    speedSlider.onValueChange = [this]() { updateSpeedLabel(); };
+    speedAttachment = std::make_unique<SliderAttachment>(parameters, BopperAudioProcessor::ParameterIds::speed, speedSlider);
     addAndMakeVisible(speedSlider);
 
     // Speed label - thin futuristic font
@@ -39,68 +70,61 @@ BopperAudioProcessorEditor::BopperAudioProcessorEditor(BopperAudioProcessor& p)
     updateSpeedLabel();
     addAndMakeVisible(speedLabel);
 
+    // What one loop of the GIF spans
+    syncModeCombo.setName("Sync Mode");
+    for (int i = 0; i < BpmSync::numSyncModes; ++i)
+        syncModeCombo.addItem(BpmSync::getSyncModeName(static_cast<BpmSync::SyncMode>(i)), i + 1);
+    syncModeAttachment = std::make_unique<ComboBoxAttachment>(parameters, BopperAudioProcessor::ParameterIds::syncMode, syncModeCombo);
+    addAndMakeVisible(syncModeCombo);
+
     // Effects controls
     reverseButton.setButtonText("REV");
     reverseButton.setClickingTogglesState(true);
-    reverseButton.setToggleState(audioProcessor.getReverseEnabled(), juce::dontSendNotification);
+    reverseAttachment = std::make_unique<ButtonAttachment>(parameters, BopperAudioProcessor::ParameterIds::reverse, reverseButton);
     reverseButton.onClick = [this]()
     {
-        audioProcessor.setReverseEnabled(reverseButton.getToggleState());
         // Disable ping-pong if reverse is enabled (mutually exclusive)
         if (reverseButton.getToggleState())
-        {
-            pingPongButton.setToggleState(false, juce::dontSendNotification);
-            audioProcessor.setPingPongEnabled(false);
-        }
+            pingPongButton.setToggleState(false, juce::sendNotificationSync);
     };
     addAndMakeVisible(reverseButton);
 
     pingPongButton.setButtonText("PING");
     pingPongButton.setClickingTogglesState(true);
-    pingPongButton.setToggleState(audioProcessor.getPingPongEnabled(), juce::dontSendNotification);
+    pingPongAttachment = std::make_unique<ButtonAttachment>(parameters, BopperAudioProcessor::ParameterIds::pingPong, pingPongButton);
     pingPongButton.onClick = [this]()
     {
-        audioProcessor.setPingPongEnabled(pingPongButton.getToggleState());
         // Disable reverse if ping-pong is enabled (mutually exclusive)
         if (pingPongButton.getToggleState())
-        {
-            reverseButton.setToggleState(false, juce::dontSendNotification);
-            audioProcessor.setReverseEnabled(false);
-        }
+            reverseButton.setToggleState(false, juce::sendNotificationSync);
     };
     addAndMakeVisible(pingPongButton);
 
+    colorFilterCombo.setName("Color Filter");
     colorFilterCombo.addItem("None", 1);
     colorFilterCombo.addItem("Invert", 2);
     colorFilterCombo.addItem("Sepia", 3);
     colorFilterCombo.addItem("Cyber", 4);
     colorFilterCombo.addItem("Vapor", 5);
     colorFilterCombo.addItem("Matrix", 6);
-    colorFilterCombo.setSelectedId(static_cast<int>(audioProcessor.getColorFilter()) + 1, juce::dontSendNotification);
-    colorFilterCombo.onChange = [this]()
-    {
-        audioProcessor.setColorFilter(static_cast<ColorFilterType>(colorFilterCombo.getSelectedId() - 1));
-    };
+    colorFilterAttachment = std::make_unique<ComboBoxAttachment>(parameters, BopperAudioProcessor::ParameterIds::colorFilter, colorFilterCombo);
     addAndMakeVisible(colorFilterCombo);
 
     pulseButton.setButtonText("PULSE");
     pulseButton.setClickingTogglesState(true);
-    pulseButton.setToggleState(audioProcessor.getPulseEnabled(), juce::dontSendNotification);
-    pulseButton.onClick = [this]()
-    {
-        audioProcessor.setPulseEnabled(pulseButton.getToggleState());
-    };
+    pulseAttachment = std::make_unique<ButtonAttachment>(parameters, BopperAudioProcessor::ParameterIds::pulse, pulseButton);
     addAndMakeVisible(pulseButton);
 
     shakeButton.setButtonText("SHAKE");
     shakeButton.setClickingTogglesState(true);
-    shakeButton.setToggleState(audioProcessor.getShakeEnabled(), juce::dontSendNotification);
-    shakeButton.onClick = [this]()
-    {
-        audioProcessor.setShakeEnabled(shakeButton.getToggleState());
-    };
+    shakeAttachment = std::make_unique<ButtonAttachment>(parameters, BopperAudioProcessor::ParameterIds::shake, shakeButton);
     addAndMakeVisible(shakeButton);
 
+    reactButton.setButtonText("REACT");
+    reactButton.setClickingTogglesState(true);
+    reactAttachment = std::make_unique<ButtonAttachment>(parameters, BopperAudioProcessor::ParameterIds::reactive, reactButton);
+    addAndMakeVisible(reactButton);
+
     // Theater mode button
     theaterButton.setButtonText("Theater");
     theaterButton.onClick = [this]()
@@ -119,6 +143,7 @@ BopperAudioProcessorEditor::BopperAudioProcessorEditor(BopperAudioProcessor& p)
 
     // GIF display
     gifDisplay.setAnimator(&gifAnimator);
+    gifDisplay.setMetrics(&audioProcessor.getMetrics());
     addAndMakeVisible(gifDisplay);
 
     // GIF selector callbacks
@@ -152,6 +177,9 @@ BopperAudioProcessorEditor::BopperAudioProcessorEditor(BopperAudioProcessor& p)
         gifSelector.updateSavedSlotState(i, hasGif);
     }
 
+    // Lay out first so the initial GIF is decoded at the display's resolution
+    setSize(500, 500);
+
     // Load initial preset
     int savedIndex = audioProcessor.getSelectedGifIndex();
     if (savedIndex >= 0 && savedIndex < 3)
@@ -160,10 +188,13 @@ BopperAudioProcessorEditor::BopperAudioProcessorEditor(BopperAudioProcessor& p)
         loadPresetGif(savedIndex);
     }
 
+    // Triggers and settings changes queued while the editor was closed are stale
+    audioProcessor.getMidiTriggerFifo().pop(pendingTriggers.data(), static_cast<int>(pendingTriggers.size()));
+    audioProcessor.getVisualSettingsFifo().pop(pendingSettings.data(), static_cast<int>(pendingSettings.size()));
+    visualSettings = audioProcessor.getVisualSettings();
+
     // Start timer for UI updates (60fps)
     startTimerHz(60);
-
-    setSize(500, 500);
 }
 
 BopperAudioProcessorEditor::~BopperAudioProcessorEditor()
@@ -192,13 +223,16 @@ void BopperAudioProcessorEditor::resized()
         // Hide normal UI elements
         titleLabel.setVisible(false);
         bpmLabel.setVisible(false);
+        playButton.setVisible(false);
         speedSlider.setVisible(false);
         speedLabel.setVisible(false);
+        syncModeCombo.setVisible(false);
         reverseButton.setVisible(false);
         pingPongButton.setVisible(false);
         colorFilterCombo.setVisible(false);
         pulseButton.setVisible(false);
         shakeButton.setVisible(false);
+        reactButton.setVisible(false);
         gifSelector.setVisible(false);
 
         // Show theater banner and exit button
@@ -214,6 +248,9 @@ void BopperAudioProcessorEditor::resized()
             bannerBounds.getCentreY() - buttonHeight / 2,
             buttonWidth, buttonHeight);
         theaterButton.toFront(false); // Bring button above banner
+
+        // Theater mode shows the GIF at its native resolution
+        gifAnimator.setMaxDimension(0);
         return;
     }
 
@@ -225,13 +262,16 @@ void BopperAudioProcessorEditor::resized()
 
     titleLabel.setVisible(true);
     bpmLabel.setVisible(true);
+    playButton.setVisible(hasInternalTransport);
     speedSlider.setVisible(true);
     speedLabel.setVisible(true);
+    syncModeCombo.setVisible(true);
     reverseButton.setVisible(true);
     pingPongButton.setVisible(true);
     colorFilterCombo.setVisible(true);
     pulseButton.setVisible(true);
     shakeButton.setVisible(true);
+    reactButton.setVisible(true);
     gifSelector.setVisible(true);
     theaterButton.setVisible(true);
     theaterButton.setButtonText("Theater");
@@ -240,6 +280,11 @@ void BopperAudioProcessorEditor::resized()
     auto headerRow = bounds.removeFromTop(40);
     titleLabel.setBounds(headerRow.removeFromLeft(100));
     theaterButton.setBounds(headerRow.removeFromRight(80));
+    if (hasInternalTransport)
+    {
+        headerRow.removeFromRight(6);
+        playButton.setBounds(headerRow.removeFromRight(50));
+    }
     bpmLabel.setBounds(headerRow);
 
     bounds.removeFromTop(8); // spacing
@@ -247,6 +292,7 @@ void BopperAudioProcessorEditor::resized()
     // Speed control row
     auto speedRow = bounds.removeFromTop(30);
     speedLabel.setBounds(speedRow.removeFromLeft(80));
+    syncModeCombo.setBounds(speedRow.removeFromRight(80).reduced(0, 2));
     speedSlider.setBounds(speedRow.reduced(4, 0));
 
     bounds.removeFromTop(6); // spacing
@@ -264,6 +310,8 @@ void BopperAudioProcessorEditor::resized()
     pulseButton.setBounds(effectsRow.removeFromLeft(55));
     effectsRow.removeFromLeft(spacing);
     shakeButton.setBounds(effectsRow.removeFromLeft(55));
+    effectsRow.removeFromLeft(spacing);
+    reactButton.setBounds(effectsRow.removeFromLeft(60));
 
     bounds.removeFromTop(8); // spacing
 
@@ -275,66 +323,622 @@ void BopperAudioProcessorEditor::resized()
 
     // GIF selector
     gifSelector.setBounds(bounds);
+
+    updateGifResolution();
+}
+
+void BopperAudioProcessorEditor::updateGifResolution()
+{
+    // Decode at the size the display can actually show (with pulse headroom and
+    // display scaling), rounded up so small layout changes don't force a re-decode
+    float scale = 1.0f;
+    if (auto* display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
+        scale = static_cast<float>(display->scale);
+
+    int longestSide = juce::jmax(gifDisplay.getWidth(), gifDisplay.getHeight());
+    int needed = juce::roundToInt(static_cast<float>(longestSide) * scale * 1.08f);
+    const int step = 128;
+    gifAnimator.setMaxDimension(juce::jmax(step, (needed + step - 1) / step * step));
+}
+
+void BopperAudioProcessorEditor::mouseDown(const juce::MouseEvent& event)
+{
+    if (event.eventComponent == &titleLabel && event.mods.isPopupMenu())
+        showTitleMenu();
+}
+
+void BopperAudioProcessorEditor::showTitleMenu()
+{
+    const bool recording = TraceRecorder::isEnabled();
+
+    juce::PopupMenu menu;
+    menu.addItem("Record Trace", true, recording, []()
+    {
+        if (TraceRecorder::isEnabled())
+        {
+            TraceRecorder::setEnabled(false);
+        }
+        else
+        {
+            TraceRecorder::clear();
+            TraceRecorder::setEnabled(true);
+        }
+    });
+    menu.addItem("Save Trace...", [this]() { saveTrace(); });
+    menu.addSeparator();
+    menu.addItem("Performance HUD", true, gifDisplay.isHudVisible(), [this]()
+    {
+        gifDisplay.setHudVisible(!gifDisplay.isHudVisible());
+    });
+    menu.addItem("Cached Chrome", true, lookAndFeel.isChromeCacheEnabled(), [this]()
+    {
+        lookAndFeel.setChromeCacheEnabled(!lookAndFeel.isChromeCacheEnabled());
+        repaint();
+    });
+    menu.addItem("Profile Paint Costs", true, lookAndFeel.isPaintProfilingEnabled(), [this]()
+    {
+        // Each profiling run starts from zero
+        const bool shouldProfile = !lookAndFeel.isPaintProfilingEnabled();
+        if (shouldProfile)
+            lookAndFeel.resetPaintCosts();
+        lookAndFeel.setPaintProfilingEnabled(shouldProfile);
+    });
+    menu.addItem("Show Paint Costs...", [this]() { showPaintCosts(); });
+
+    // How hard the animation is pulled onto the audio's timing between blocks
+    juce::PopupMenu timingMenu;
+    timingMenu.addItem("Raw", true, !smoothTiming, [this]() { smoothTiming = false; });
+    const std::pair<const char*, double> stiffnesses[] = {{"Loose", 4.0}, {"Medium", 10.0}, {"Tight", 25.0}};
+    for (const auto& [name, stiffness] : stiffnesses)
+    {
+        const bool selected = smoothTiming && phaseFollower.getStiffness() == stiffness;
+        timingMenu.addItem(name, true, selected, [this, stiffness = stiffness]()
+        {
+            smoothTiming = true;
+            phaseFollower.setStiffness(stiffness);
+        });
+    }
+    menu.addSubMenu("Timing", timingMenu);
+    menu.addSeparator();
+    menu.addSubMenu("Scene Sequencer", createSceneMenu());
+    menu.addItem("MIDI Triggers", true, audioProcessor.getMidiTriggersEnabled(), [this]()
+    {
+        audioProcessor.setMidiTriggersEnabled(!audioProcessor.getMidiTriggersEnabled());
+    });
+
+    // Shared by every Bopper instance in the host
+    juce::PopupMenu budgetMenu;
+    auto& accountant = MemoryAccountant::getInstance();
+    for (int megabytes : {128, 256, 512, 1024, 2048})
+    {
+        const size_t bytes = static_cast<size_t>(megabytes) * 1024 * 1024;
+        budgetMenu.addItem(juce::String(megabytes) + " MB", true, accountant.getBudget() == bytes, [bytes]()
+        {
+            MemoryAccountant::getInstance().setBudget(bytes);
+        });
+    }
+    menu.addSubMenu("Memory Budget", budgetMenu);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&titleLabel));
+}
+
+void BopperAudioProcessorEditor::saveTrace()
+{
+    // Events can only be read back once recording has stopped
+    TraceRecorder::setEnabled(false);
+
+    fileChooser = std::make_unique<juce::FileChooser>(
+        "Save trace",
+        juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("bopper-trace.json"),
+        "*.json");
+
+    auto chooserFlags = juce::FileBrowserComponent::saveMode |
+                        juce::FileBrowserComponent::canSelectFiles |
+                        juce::FileBrowserComponent::warnAboutOverwriting;
+
+    fileChooser->launchAsync(chooserFlags, [](const juce::FileChooser& fc)
+    {
+        auto file = fc.getResult();
+        if (file != juce::File() && !TraceRecorder::writeChromeTrace(file))
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                   "Save Trace",
+                                                   "Could not write " + file.getFullPathName());
+        }
+    });
+}
+
+void BopperAudioProcessorEditor::showPaintCosts()
+{
+    juce::String report;
+    report << "GIF display: " << audioProcessor.getMetrics().format(PerformanceMetrics::Metric::PaintMs)
+           << " per paint (average)\n\n";
+
+    for (const auto& cost : lookAndFeel.getPaintCosts())
+    {
+        report << cost.name << ": " << cost.calls << " draws, "
+               << juce::String(cost.totalMs / cost.calls, 3) << " ms mean, "
+               << juce::String(cost.worstMs, 3) << " ms worst\n";
+    }
+
+    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon,
+                                           "Paint Costs (" + juce::String(lookAndFeel.isChromeCacheEnabled() ? "cached" : "live") + " chrome)",
+                                           report);
 }
 
 void BopperAudioProcessorEditor::timerCallback()
 {
+    BOPPER_TRACE_SCOPE("Editor::timerCallback");
+
     // Update BPM display
     double bpm = audioProcessor.getBpm();
-    bpmLabel.setText("BPM: " + juce::String(static_cast<int>(bpm)), juce::dontSendNotification);
+    // Tempo followed from the input is marked as such
+    juce::String bpmPrefix = audioProcessor.isFollowingAudio() ? "AUDIO BPM: " : "BPM: ";
+    if (!bpmLabel.isBeingEdited())
+        bpmLabel.setText(bpmPrefix + juce::String(static_cast<int>(bpm)), juce::dontSendNotification);
+
+    displayPpq = getDisplayPpq();
+    applyVisualSettingsChanges();
+    updateScene();
+
+    // Rebuild the loop mapping only when the sync settings or the bar change
+    BpmSync::LoopSettings settings;
+    settings.mode = activeSettings.syncMode;
+    settings.speedIndex = activeSettings.speedDivisor;
+    settings.numerator = transport.numerator;
+    settings.denominator = transport.denominator;
+    settings.barStartPpq = transport.barStartPpq;
+
+    if (settings != loopSettings)
+    {
+        loopSettings = settings;
+        loopMapping = BpmSync::makeLoopMapping(loopSettings);
+    }
+
+    applyMidiTriggers();
 
-    // Update animation with speed divisor and direction effects
-    int speedDiv = audioProcessor.getSpeedDivisor();
-    bool reverse = audioProcessor.getReverseEnabled();
-    bool pingPong = audioProcessor.getPingPongEnabled();
-    gifAnimator.update(bpm, audioProcessor.getPpqPosition(), audioProcessor.isHostPlaying(),
-                       speedDiv, reverse, pingPong);
+    // Update animation with the loop mapping and direction effects
+    gifAnimator.update(displayPpq, transport.isPlaying, loopMapping,
+                       activeSettings.reverse, activeSettings.pingPong);
 
     // Pass effect settings to display
-    gifDisplay.setEffects(audioProcessor.getColorFilter(),
-                          audioProcessor.getPulseEnabled(),
-                          audioProcessor.getShakeEnabled(),
+    gifDisplay.setEffects(activeSettings.colorFilter,
+                          activeSettings.pulse,
+                          activeSettings.shake,
                           gifAnimator.getCurrentBeatPhase());
 
+    // Always drain the input levels so they're current when REACT is switched on
+    int numBlocks = audioProcessor.getAudioLevelsFifo().pop(audioBlocks.data(), static_cast<int>(audioBlocks.size()));
+    audioEnvelope.update(audioBlocks.data(), numBlocks);
+    gifDisplay.setAudioReactive(activeSettings.reactive, audioEnvelope.get());
+
+    updateMetrics();
+
     // Repaint GIF display
     gifDisplay.updateDisplay();
 }
 
+double BopperAudioProcessorEditor::getDisplayPpq()
+{
+    transport = audioProcessor.getTransportSnapshot();
+    const double now = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks());
+    const double reported = juce::Time::highResolutionTicksToSeconds(transport.ppqTimestamp);
+
+    // Where the audio is by now, for the phase error metric
+    audioPpq = PhaseFollower::extrapolate(now, transport.ppqPosition, reported, transport.bpm);
+
+    if (!smoothTiming || !transport.isPlaying)
+    {
+        phaseFollower.reset();
+        return transport.ppqPosition;
+    }
+
+    return phaseFollower.update(now, transport.ppqPosition, reported, transport.bpm);
+}
+
+void BopperAudioProcessorEditor::applyVisualSettingsChanges()
+{
+    auto& changes = audioProcessor.getVisualSettingsFifo();
+    numPendingSettings += changes.pop(pendingSettings.data() + numPendingSettings,
+                                      static_cast<int>(pendingSettings.size()) - numPendingSettings);
+
+    // Stopped, nothing is on a beat: show the controls as they are now
+    if (!transport.isPlaying)
+    {
+        numPendingSettings = 0;
+        visualSettings = audioProcessor.getVisualSettings();
+        return;
+    }
+
+    // Playing, each change waits for the beat it was automated on. One that
+    // has waited too long was left behind by a host loop or relocation.
+    const auto now = juce::Time::getHighResolutionTicks();
+    const auto maxWait = juce::Time::secondsToHighResolutionTicks(0.5);
+
+    int applied = 0;
+    while (applied < numPendingSettings)
+    {
+        const auto& change = pendingSettings[static_cast<size_t>(applied)];
+        if (change.ppqPosition > displayPpq && now - change.ticks < maxWait)
+            break;
+
+        visualSettings = change.settings;
+        ++applied;
+    }
+
+    std::move(pendingSettings.begin() + applied, pendingSettings.begin() + numPendingSettings, pendingSettings.begin());
+    numPendingSettings -= applied;
+}
+
+void BopperAudioProcessorEditor::updateScene()
+{
+    const auto& sequencer = audioProcessor.getSceneSequencer();
+    activeSettings = visualSettings;
+
+    if (!sequencer.isEnabled())
+    {
+        currentSceneStep = noSceneStep;
+        scenePrefetch.reset();
+        gifAnimator.cancelPrepare();
+        return;
+    }
+
+    const double barLength = BpmSync::barLengthPpq(transport.numerator, transport.denominator);
+    const auto step = sequencer.stepNumberAt(displayPpq, transport.barStartPpq, barLength);
+
+    // Stopped: have the step that will play first ready for when the transport starts
+    if (!transport.isPlaying)
+    {
+        currentSceneStep = noSceneStep;
+        if (scenePrefetch == nullptr || scenePrefetch->step != step)
+            prefetchScene(step);
+        return;
+    }
+
+    if (step != currentSceneStep)
+    {
+        currentSceneStep = step;
+        enterScene(step);
+        prefetchScene(step + 1);
+    }
+
+    const auto& scene = sequencer.sceneForStep(currentSceneStep);
+    activeSettings.speedDivisor = scene.speedDivisor;
+    activeSettings.colorFilter = scene.filter;
+    activeSettings.reverse = scene.reverse;
+    activeSettings.pingPong = scene.pingPong;
+}
+
+void BopperAudioProcessorEditor::enterScene(juce::int64 step)
+{
+    const auto& scene = audioProcessor.getSceneSequencer().sceneForStep(step);
+    if (scene.gif == Scene::keepGif)
+        return;
+
+    // Prefetched for this downbeat: swap it in, no decoding here
+    const bool prefetched = scenePrefetch != nullptr && scenePrefetch->done.load()
+                         && scenePrefetch->step == step && scenePrefetch->gif == scene.gif
+                         && scenePrefetch->filter == scene.filter && scenePrefetch->result.has_value();
+
+    if (prefetched)
+    {
+        BOPPER_TRACE_SCOPE("Editor::adoptScene");
+        gifAnimator.adopt(std::move(*scenePrefetch->result));
+        scenePrefetch.reset();
+        loadedGif = scene.gif;
+
+        if (scene.gif < Scene::firstSlotGif)
+        {
+            gifSelector.setSelectedPreset(scene.gif);
+            audioProcessor.setSelectedGifIndex(scene.gif);
+        }
+        else
+        {
+            gifSelector.setSelectedSavedSlot(scene.gif - Scene::firstSlotGif);
+            audioProcessor.setSelectedGifIndex(-1);
+        }
+
+        gifDisplay.updateDisplay();
+        return;
+    }
+
+    // Not ready in time (or the pattern just changed): load it now, with the
+    // memory held for the prefetch back in the budget
+    scenePrefetch.reset();
+    gifAnimator.cancelPrepare();
+
+    if (scene.gif != loadedGif)
+    {
+        BOPPER_TRACE_SCOPE("Editor::loadSceneLate");
+        loadSceneGif(scene.gif);
+    }
+}
+
+void BopperAudioProcessorEditor::prefetchScene(juce::int64 step)
+{
+    const auto& scene = audioProcessor.getSceneSequencer().sceneForStep(step);
+
+    // Anything still queued is for a step that has gone
+    prefetchPool.removeAllJobs(false, 0);
+
+    auto prefetch = std::make_shared<ScenePrefetch>();
+    prefetch->step = step;
+    prefetch->gif = scene.gif;
+    prefetch->filter = scene.filter;
+    scenePrefetch = prefetch;
+
+    const auto filter = scene.filter;
+    std::function<std::optional<GifAnimator::PreparedGif>(const GifLoader::LoadOptions&)> prepare;
+
+    if (scene.gif != Scene::keepGif && scene.gif < Scene::firstSlotGif)
+    {
+        const void* data = nullptr;
+        size_t size = 0;
+        if (getPresetGifData(scene.gif, data, size))
+            prepare = [data, size, filter](const auto& options) { return GifAnimator::prepare(data, size, options, filter); };
+    }
+    else if (scene.gif != Scene::keepGif)
+    {
+        const juce::File file(audioProcessor.getSavedGifPath(scene.gif - Scene::firstSlotGif));
+        if (file.existsAsFile())
+            prepare = [file, filter](const auto& options) { return GifAnimator::prepare(file, options, filter); };
+    }
+
+    // Same resolution limit as a load right now, within memory held for it.
+    // Nothing to load (the step keeps the GIF on screen, or its slot is
+    // empty) or no room for it: the downbeat loads it instead.
+    const auto options = prepare != nullptr ? gifAnimator.reserveForPrepare(filter) : std::nullopt;
+    if (!options.has_value())
+    {
+        gifAnimator.cancelPrepare();
+        prefetch->done.store(true);
+        return;
+    }
+
+    prefetchPool.addJob([prefetch, prepare, options = *options]()
+    {
+        prefetch->result = prepare(options);
+        prefetch->done.store(true);
+    });
+}
+
+void BopperAudioProcessorEditor::loadSceneGif(int gif)
+{
+    if (gif < Scene::firstSlotGif)
+    {
+        gifSelector.setSelectedPreset(gif);
+        loadPresetGif(gif);
+        audioProcessor.setSelectedGifIndex(gif);
+    }
+    else
+    {
+        loadSavedGif(gif - Scene::firstSlotGif);
+    }
+}
+
+void BopperAudioProcessorEditor::sceneEdited()
+{
+    // Apply the edited step straight away and fetch the next one again
+    currentSceneStep = noSceneStep;
+    scenePrefetch.reset();
+    gifAnimator.cancelPrepare();
+}
+
+juce::PopupMenu BopperAudioProcessorEditor::createSceneMenu()
+{
+    auto& sequencer = audioProcessor.getSceneSequencer();
+    juce::PopupMenu menu;
+
+    menu.addItem("Play Scenes", true, sequencer.isEnabled(), [this, &sequencer]()
+    {
+        sequencer.setEnabled(!sequencer.isEnabled());
+        sceneEdited();
+    });
+
+    juce::PopupMenu lengthMenu;
+    lengthMenu.addItem("Beat", true, sequencer.getStepLength() == SceneSequencer::StepLength::Beat, [this, &sequencer]()
+    {
+        sequencer.setStepLength(SceneSequencer::StepLength::Beat);
+        sceneEdited();
+    });
+    lengthMenu.addItem("Bar", true, sequencer.getStepLength() == SceneSequencer::StepLength::Bar, [this, &sequencer]()
+    {
+        sequencer.setStepLength(SceneSequencer::StepLength::Bar);
+        sceneEdited();
+    });
+    menu.addSubMenu("Step Length", lengthMenu);
+
+    juce::PopupMenu countMenu;
+    for (int count : {1, 2, 4, 8, 16})
+    {
+        countMenu.addItem(juce::String(count), true, sequencer.getNumSteps() == count, [this, &sequencer, count]()
+        {
+            sequencer.setNumSteps(count);
+            sceneEdited();
+        });
+    }
+    menu.addSubMenu("Steps", countMenu);
+    menu.addSeparator();
+
+    for (int i = 0; i < sequencer.getNumSteps(); ++i)
+    {
+        auto& scene = sequencer.getStep(i);
+
+        juce::PopupMenu gifMenu;
+        gifMenu.addItem("Keep", true, scene.gif == Scene::keepGif, [this, &scene]()
+        {
+            scene.gif = Scene::keepGif;
+            sceneEdited();
+        });
+        for (int gif = 0; gif < Scene::numGifs; ++gif)
+        {
+            const juce::String name = gif < Scene::firstSlotGif ? juce::String(getPresetGifs()[static_cast<size_t>(gif)].name)
+                                                                : "Slot " + juce::String(gif - Scene::firstSlotGif + 1);
+            gifMenu.addItem(name, true, scene.gif == gif, [this, &scene, gif]()
+            {
+                scene.gif = gif;
+                sceneEdited();
+            });
+        }
+
+        juce::PopupMenu filterMenu;
+        for (int filter = 0; filter < ColorFilter::numFilters; ++filter)
+        {
+            const auto type = static_cast<ColorFilterType>(filter);
+            filterMenu.addItem(ColorFilter::getName(type), true, scene.filter == type, [this, &scene, type]()
+            {
+                scene.filter = type;
+                sceneEdited();
+            });
+        }
+
+        juce::PopupMenu speedMenu;
+        for (int divisor = BopperAudioProcessor::minSpeedDivisor; divisor <= BopperAudioProcessor::maxSpeedDivisor; ++divisor)
+        {
+            speedMenu.addItem(getSpeedName(divisor), true, scene.speedDivisor == divisor, [this, &scene, divisor]()
+            {
+                scene.speedDivisor = divisor;
+                sceneEdited();
+            });
+        }
+
+        juce::PopupMenu directionMenu;
+        directionMenu.addItem("Forward", true, !scene.reverse && !scene.pingPong, [this, &scene]()
+        {
+            scene.reverse = false;
+            scene.pingPong = false;
+            sceneEdited();
+        });
+        directionMenu.addItem("Reverse", true, scene.reverse, [this, &scene]()
+        {
+            scene.reverse = true;
+            scene.pingPong = false;
+            sceneEdited();
+        });
+        directionMenu.addItem("Ping-Pong", true, scene.pingPong, [this, &scene]()
+        {
+            scene.reverse = false;
+            scene.pingPong = true;
+            sceneEdited();
+        });
+
+        juce::PopupMenu stepMenu;
+        stepMenu.addSubMenu("GIF", gifMenu);
+        stepMenu.addSubMenu("Filter", filterMenu);
+        stepMenu.addSubMenu("Speed", speedMenu);
+        stepMenu.addSubMenu("Direction", directionMenu);
+        menu.addSubMenu("Step " + juce::String(i + 1), stepMenu);
+    }
+
+    return menu;
+}
+
+void BopperAudioProcessorEditor::applyMidiTriggers()
+{
+    numPendingTriggers += audioProcessor.getMidiTriggerFifo().pop(pendingTriggers.data() + numPendingTriggers,
+                                                                 static_cast<int>(pendingTriggers.size()) - numPendingTriggers);
+
+    // A note lands on the refresh nearest the time it sounds; notes later in a
+    // large block wait for theirs
+    const auto due = juce::Time::getHighResolutionTicks()
+                   + juce::Time::secondsToHighResolutionTicks(getTimerInterval() * 0.0005);
+
+    int applied = 0;
+    while (applied < numPendingTriggers && pendingTriggers[static_cast<size_t>(applied)].ticks <= due)
+        applyMidiTrigger(pendingTriggers[static_cast<size_t>(applied++)]);
+
+    std::move(pendingTriggers.begin() + applied, pendingTriggers.begin() + numPendingTriggers, pendingTriggers.begin());
+    numPendingTriggers -= applied;
+}
+
+void BopperAudioProcessorEditor::applyMidiTrigger(const MidiTrigger& trigger)
+{
+    const bool reverse = activeSettings.reverse;
+    const bool pingPong = activeSettings.pingPong;
+
+    switch (trigger.action)
+    {
+        case MidiTrigger::Action::Retrigger:
+        {
+            // The first frame of the loop in the current direction
+            const int firstFrame = reverse && !pingPong ? gifAnimator.getFrameCount() - 1 : 0;
+            gifAnimator.jumpToFrame(firstFrame, trigger.ppqPosition, loopMapping, reverse, pingPong);
+            break;
+        }
+
+        case MidiTrigger::Action::JumpToFrame:
+            if (gifAnimator.isLoaded())
+                gifAnimator.jumpToFrame(trigger.value % gifAnimator.getFrameCount(), trigger.ppqPosition,
+                                        loopMapping, reverse, pingPong);
+            break;
+
+        case MidiTrigger::Action::SelectPreset:
+            gifSelector.setSelectedPreset(trigger.value);
+            loadPresetGif(trigger.value);
+            audioProcessor.setSelectedGifIndex(trigger.value);
+            break;
+
+        case MidiTrigger::Action::SelectSlot:
+            loadSavedGif(trigger.value);
+            break;
+    }
+}
+
+void BopperAudioProcessorEditor::updateMetrics()
+{
+    using Metric = PerformanceMetrics::Metric;
+    auto& metrics = audioProcessor.getMetrics();
+    const auto now = juce::Time::getHighResolutionTicks();
+
+    if (lastTimerTicks != 0)
+    {
+        double intervalMs = juce::Time::highResolutionTicksToSeconds(now - lastTimerTicks) * 1000.0;
+        metrics.addSample(Metric::TimerJitterMs, std::abs(intervalMs - getTimerInterval()));
+    }
+    lastTimerTicks = now;
+
+    metrics.set(Metric::DroppedFrames, gifAnimator.getDroppedFrameChanges());
+    metrics.set(Metric::ResidentBytes, static_cast<double>(gifAnimator.getResidentBytes()));
+
+    // The frame was chosen from displayPpq; the error is how far that is from
+    // the audio's position extrapolated to this refresh, in time at the tempo
+    if (transport.isPlaying && transport.bpm > 0.0)
+    {
+        double errorMs = std::abs(audioPpq - displayPpq) * 60000.0 / transport.bpm;
+        metrics.addSample(Metric::PhaseErrorMs, errorMs);
+    }
+}
+
 void BopperAudioProcessorEditor::updateSpeedLabel()
 {
-    int divisor = static_cast<int>(speedSlider.getValue());
-    juce::String speedText;
+    speedLabel.setText(getSpeedName(static_cast<int>(speedSlider.getValue())), juce::dontSendNotification);
+}
+
+juce::String BopperAudioProcessorEditor::getSpeedName(int divisor)
+{
     switch (divisor)
     {
-        case 0: speedText = "Normal"; break;
-        case 1: speedText = "Slow"; break;
-        case 2: speedText = "Slower"; break;
-        case 3: speedText = "Even Slower"; break;
-        case 4: speedText = "Slowest"; break;
-        default: speedText = "Normal"; break;
+        case -2: return "4x";
+        case -1: return "2x";
+        case 0: return "Normal";
+        case 1: return "Slow";
+        case 2: return "Slower";
+        case 3: return "Even Slower";
+        case 4: return "Slowest";
+        default: return "Normal";
     }
-    speedLabel.setText(speedText, juce::dontSendNotification);
 }
 
 void BopperAudioProcessorEditor::loadPresetGif(int index)
 {
-    if (index < 0 || index >= 3)
+    const void* data = nullptr;
+    size_t dataSize = 0;
+    if (!getPresetGifData(index, data, dataSize))
         return;
 
-    // Load from embedded binary data
-    const char* binaryDataPtrs[] = {
-        BinaryData::spongebob_gif,
-        BinaryData::gandalf_gif,
-        BinaryData::Dance_Band_GIF_gif
-    };
+    loadedGif = index;
 
-    const int binaryDataSizes[] = {
-        BinaryData::spongebob_gifSize,
-        BinaryData::gandalf_gifSize,
-        BinaryData::Dance_Band_GIF_gifSize
-    };
-
-    if (gifAnimator.loadGif(binaryDataPtrs[index], static_cast<size_t>(binaryDataSizes[index])))
+    if (gifAnimator.loadGif(data, dataSize))
     {
         gifDisplay.updateDisplay();
         return;
@@ -395,12 +999,17 @@ void BopperAudioProcessorEditor::uploadToSlot(int slot)
                 gifSelector.updateSavedSlotState(pendingUploadSlot, true);
 
                 // Update selection state
+                loadedGif = Scene::firstSlotGif + pendingUploadSlot;
                 audioProcessor.setSelectedGifIndex(-1);
                 gifSelector.setSelectedPreset(-1);
                 gifSelector.setSelectedSavedSlot(pendingUploadSlot);
                 gifDisplay.updateDisplay();
                 repaint();
             }
+            else
+            {
+                showLoadError(file);
+            }
         }
         pendingUploadSlot = -1;
     });
@@ -414,14 +1023,26 @@ void BopperAudioProcessorEditor::loadSavedGif(int slot)
         juce::File file(path);
         if (file.existsAsFile() && gifAnimator.loadGif(file))
         {
+            loadedGif = Scene::firstSlotGif + slot;
             audioProcessor.setSelectedGifIndex(-1);
             gifSelector.setSelectedPreset(-1);
             gifSelector.setSelectedSavedSlot(slot);
             gifDisplay.updateDisplay();
         }
+        else if (file.existsAsFile())
+        {
+            showLoadError(file);
+        }
     }
 }
 
+void BopperAudioProcessorEditor::showLoadError(const juce::File& file)
+{
+    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                           "Could not load " + file.getFileName(),
+                                           GifLoader::describe(gifAnimator.getLastLoadStatus()));
+}
+
 void BopperAudioProcessorEditor::deleteFromSlot(int slot)
 {
     audioProcessor.setSavedGifPath(slot, "");
@@ -446,6 +1067,29 @@ void BopperAudioProcessorEditor::exitTheaterMode()
     resized();
 }
 
+bool BopperAudioProcessorEditor::getPresetGifData(int index, const void*& data, size_t& size)
+{
+    if (index < 0 || index >= 3)
+        return false;
+
+    // Embedded binary data
+    const char* binaryDataPtrs[] = {
+        BinaryData::spongebob_gif,
+        BinaryData::gandalf_gif,
+        BinaryData::Dance_Band_GIF_gif
+    };
+
+    const int binaryDataSizes[] = {
+        BinaryData::spongebob_gifSize,
+        BinaryData::gandalf_gifSize,
+        BinaryData::Dance_Band_GIF_gifSize
+    };
+
+    data = binaryDataPtrs[index];
+    size = static_cast<size_t>(binaryDataSizes[index]);
+    return true;
+}
+
 const std::array<BopperAudioProcessorEditor::PresetGif, 3>& BopperAudioProcessorEditor::getPresetGifs()
 {
     // Preset names - actual files loaded from gifs folder
@@ -6,6 +6,7 @@
 #include "UI/BopperLookAndFeel.h"
 #include "UI/GifDisplayComponent.h"
 #include "UI/GifSelectorComponent.h"
+#include "Utils/PhaseFollower.h"
 
 class BopperAudioProcessorEditor : public juce::AudioProcessorEditor,
                                      private juce::Timer
@@ -16,16 +17,34 @@ public:
 
     void paint(juce::Graphics&) override;
     void resized() override;
+    void mouseDown(const juce::MouseEvent& event) override;
 
 private:
     void timerCallback() override;
+    void showTitleMenu();
+    void updateMetrics();
+    void saveTrace();
+    void showPaintCosts();
+    double getDisplayPpq();
+    void applyVisualSettingsChanges();
+    void updateScene();
+    void enterScene(juce::int64 step);
+    void prefetchScene(juce::int64 step);
+    void loadSceneGif(int gif);
+    void sceneEdited();
+    juce::PopupMenu createSceneMenu();
+    void applyMidiTriggers();
+    void applyMidiTrigger(const MidiTrigger& trigger);
     void loadPresetGif(int index);
     void loadSavedGif(int slot);
     void uploadToSlot(int slot);
     void deleteFromSlot(int slot);
     void enterTheaterMode();
     void exitTheaterMode();
+    void updateGifResolution();
     void updateSpeedLabel();
+    static juce::String getSpeedName(int divisor);
+    void showLoadError(const juce::File& file);
 
     // Embedded preset GIF data
     struct PresetGif
@@ -36,6 +55,7 @@ private:
     };
 
     static const std::array<PresetGif, 3>& getPresetGifs();
+    static bool getPresetGifData(int index, const void*& data, size_t& size);
 
     BopperAudioProcessor& audioProcessor;
     BopperLookAndFeel lookAndFeel;
@@ -51,9 +71,29 @@ private:
     juce::Label titleLabel;
     juce::Label bpmLabel;
 
+    // Internal transport, shown in the Standalone app only. The BPM label is
+    // editable there and sets the internal tempo.
+    juce::TextButton playButton;
+    bool hasInternalTransport = false;
+
     // Speed control
     juce::Slider speedSlider;
     juce::Label speedLabel;
+    juce::ComboBox syncModeCombo;
+
+    // Loop mapping for the current sync settings, rebuilt only when they change
+    BpmSync::LoopSettings loopSettings;
+    BpmSync::LoopMapping loopMapping;
+
+    // Smoothed PPQ the animation follows between audio blocks
+    PhaseFollower phaseFollower;
+    bool smoothTiming = true;
+    double displayPpq = 0.0;
+
+    // The transport read once per refresh, so tempo, bar and play state agree,
+    // and the audio's position extrapolated to that refresh
+    BopperAudioProcessor::TransportSnapshot transport;
+    double audioPpq = 0.0;
 
     // Effects controls
     juce::TextButton reverseButton;
@@ -61,12 +101,64 @@ private:
     juce::ComboBox colorFilterCombo;
     juce::TextButton pulseButton;
     juce::TextButton shakeButton;
+    juce::TextButton reactButton;
+
+    // Input levels drained from the processor each tick, and their smoothed envelope
+    std::array<AudioLevels, AudioLevelsFifo::capacity> audioBlocks;
+    AudioEnvelope audioEnvelope;
+
+    // Visual settings the display uses, and automation changes waiting for their beat
+    BopperAudioProcessor::VisualSettings visualSettings;
+    std::array<BopperAudioProcessor::VisualSettingsChange, BopperAudioProcessor::VisualSettingsFifo::capacity> pendingSettings;
+    int numPendingSettings = 0;
+
+    // Settings on screen: the visual settings with the current scene's on top
+    BopperAudioProcessor::VisualSettings activeSettings;
+
+    // Scene sequencer playback. The next step's GIF is decoded and filtered on
+    // a background thread while the current step plays, then swapped in on
+    // the downbeat.
+    struct ScenePrefetch
+    {
+        juce::int64 step = 0;
+        int gif = Scene::keepGif;
+        ColorFilterType filter = ColorFilterType::None;
+        std::optional<GifAnimator::PreparedGif> result;
+        std::atomic<bool> done{false};
+    };
+
+    static constexpr juce::int64 noSceneStep = std::numeric_limits<juce::int64>::min();
+    juce::int64 currentSceneStep = noSceneStep;
+    int loadedGif = Scene::keepGif; // Preset or slot on screen, numbered as in Scene::gif
+    std::shared_ptr<ScenePrefetch> scenePrefetch;
+    juce::ThreadPool prefetchPool{1};
+
+    // MIDI triggers drained from the processor that are due on a later refresh
+    std::array<MidiTrigger, MidiTriggerFifo::capacity> pendingTriggers;
+    int numPendingTriggers = 0;
+
+    // Parameter attachments, declared after the controls so they go first
+    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+
+    std::unique_ptr<SliderAttachment> speedAttachment;
+    std::unique_ptr<ComboBoxAttachment> syncModeAttachment;
+    std::unique_ptr<ButtonAttachment> reverseAttachment;
+    std::unique_ptr<ButtonAttachment> pingPongAttachment;
+    std::unique_ptr<ComboBoxAttachment> colorFilterAttachment;
+    std::unique_ptr<ButtonAttachment> pulseAttachment;
+    std::unique_ptr<ButtonAttachment> shakeAttachment;
+    std::unique_ptr<ButtonAttachment> reactAttachment;
 
     // Theater mode button and banner
     juce::TextButton theaterButton;
     juce::Label theaterBannerLabel;
     bool isTheaterMode = false;
 
+    // Tick count of the previous timer callback, for timer jitter
+    juce::int64 lastTimerTicks = 0;
+
     // For file browsing
     std::unique_ptr<juce::FileChooser> fileChooser;
     int pendingUploadSlot = -1; // Track which slot we're uploading to
@@ -1,17 +1,81 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Utils/TraceRecorder.h"
+#include <tuple>
 
 BopperAudioProcessor::BopperAudioProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
-                     .withOutput("Output", juce::AudioChannelSet::stereo(), true))
+                     .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+                     .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)),
+      parameters(*this, nullptr, "Parameters", createParameterLayout())
 {
+    speedValue = parameters.getRawParameterValue(ParameterIds::speed);
+    syncModeValue = parameters.getRawParameterValue(ParameterIds::syncMode);
+    reverseValue = parameters.getRawParameterValue(ParameterIds::reverse);
+    pingPongValue = parameters.getRawParameterValue(ParameterIds::pingPong);
+    colorFilterValue = parameters.getRawParameterValue(ParameterIds::colorFilter);
+    pulseValue = parameters.getRawParameterValue(ParameterIds::pulse);
+    shakeValue = parameters.getRawParameterValue(ParameterIds::shake);
+    reactiveValue = parameters.getRawParameterValue(ParameterIds::reactive);
+
+    lastBlockSettings = getVisualSettings();
 }
 
 BopperAudioProcessor::~BopperAudioProcessor()
 {
 }
 
+juce::AudioProcessorValueTreeState::ParameterLayout BopperAudioProcessor::createParameterLayout()
+{
+    juce::StringArray syncModes;
+    for (int i = 0; i < BpmSync::numSyncModes; ++i)
+        syncModes.add(BpmSync::getSyncModeName(static_cast<BpmSync::SyncMode>(i)));
+
+    juce::StringArray colorFilters;
+    for (int i = 0; i < ColorFilter::numFilters; ++i)
+        colorFilters.add(ColorFilter::getName(static_cast<ColorFilterType>(i)));
+
+    return {
+        std::make_unique<juce::AudioParameterInt>(juce::ParameterID{ParameterIds::speed, 1}, "Speed",
+                                                  minSpeedDivisor, maxSpeedDivisor, 0),
+        std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ParameterIds::syncMode, 1}, "Sync Mode", syncModes, 0),
+        std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ParameterIds::reverse, 1}, "Reverse", false),
+        std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ParameterIds::pingPong, 1}, "Ping-Pong", false),
+        std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ParameterIds::colorFilter, 1}, "Color Filter", colorFilters, 0),
+        std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ParameterIds::pulse, 1}, "Pulse", false),
+        std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ParameterIds::shake, 1}, "Shake", false),
+        std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ParameterIds::reactive, 1}, "React", false)
+    };
+}
+
+void BopperAudioProcessor::setParameter(const char* parameterId, float value)
+{
+    if (auto* parameter = parameters.getParameter(parameterId))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+bool BopperAudioProcessor::VisualSettings::operator==(const VisualSettings& other) const
+{
+    return std::tie(speedDivisor, syncMode, reverse, pingPong, colorFilter, pulse, shake, reactive)
+        == std::tie(other.speedDivisor, other.syncMode, other.reverse, other.pingPong,
+                    other.colorFilter, other.pulse, other.shake, other.reactive);
+}
+
+BopperAudioProcessor::VisualSettings BopperAudioProcessor::getVisualSettings() const
+{
+    VisualSettings settings;
+    settings.speedDivisor = getSpeedDivisor();
+    settings.syncMode = getSyncMode();
+    settings.reverse = getReverseEnabled();
+    settings.pingPong = getPingPongEnabled();
+    settings.colorFilter = getColorFilter();
+    settings.pulse = getPulseEnabled();
+    settings.shake = getShakeEnabled();
+    settings.reactive = getReactiveEnabled();
+    return settings;
+}
+
 const juce::String BopperAudioProcessor::getName() const
 {
     return JucePlugin_Name;
@@ -19,7 +83,7 @@ const juce::String BopperAudioProcessor::getName() const
 
 bool BopperAudioProcessor::acceptsMidi() const
 {
-    return false;
+    return true;
 }
 
 bool BopperAudioProcessor::producesMidi() const
@@ -65,7 +129,9 @@ void BopperAudioProcessor::changeProgramName(int index, const juce::String& newN
 
 void BopperAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused(sampleRate, samplesPerBlock);
+    juce::ignoreUnused(samplesPerBlock);
+    beatTracker.prepare(sampleRate);
+    audioAnalyser.prepare(sampleRate);
 }
 
 void BopperAudioProcessor::releaseResources()
@@ -81,22 +147,48 @@ bool BopperAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) co
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
 
+    // Optional sidechain, analysed instead of the main input when connected
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet(true, 1);
+        if (!sidechain.isDisabled()
+            && sidechain != juce::AudioChannelSet::mono()
+            && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
+
     return true;
 }
 
 void BopperAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                           juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused(midiMessages);
+    BOPPER_TRACE_SCOPE("processBlock");
     juce::ScopedNoDenormals noDenormals;
+    const auto blockTicks = juce::Time::getHighResolutionTicks();
 
     // Pass through audio unchanged
     // (This is a visual-only plugin)
 
+    // Effects and the beat tracker follow the sidechain when the host feeds
+    // one, otherwise the main input. The main signal is never touched.
+    auto* sidechainBus = getBus(true, 1);
+    const bool hasSidechain = sidechainBus != nullptr && sidechainBus->isEnabled()
+                           && sidechainBus->getNumberOfChannels() > 0;
+    const auto analysisInput = getBusBuffer(buffer, true, hasSidechain ? 1 : 0);
+
+    // Input levels for the audio-reactive effects
+    audioLevelsFifo.push(audioAnalyser.analyse(analysisInput.getArrayOfReadPointers(),
+                                               analysisInput.getNumChannels(), analysisInput.getNumSamples()));
+
     // Extract BPM and transport info from host
     double currentBpm = 120.0;
     bool isPlaying = false;
     double ppqPosition = 0.0;
+    bool hostHasTempo = false;
+    int numerator = 4;
+    int denominator = 4;
+    std::optional<double> barStart;
 
     if (auto* playHead = getPlayHead())
     {
@@ -106,7 +198,10 @@ void BopperAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
             if (auto bpm = positionInfo->getBpm())
             {
                 if (*bpm > 0.0)
+                {
                     currentBpm = *bpm;
+                    hostHasTempo = true;
+                }
             }
 
             // Get playback state
@@ -117,13 +212,128 @@ void BopperAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
             {
                 ppqPosition = *ppq;
             }
+
+            // Time signature and bar start for bar-synced loops
+            if (auto timeSignature = positionInfo->getTimeSignature())
+            {
+                if (timeSignature->numerator > 0 && timeSignature->denominator > 0)
+                {
+                    numerator = timeSignature->numerator;
+                    denominator = timeSignature->denominator;
+                }
+            }
+
+            if (auto lastBarStart = positionInfo->getPpqPositionOfLastBarStart())
+                barStart = *lastBarStart;
+        }
+    }
+
+    // No tempo from the host (or Standalone): run the internal transport if it's
+    // playing, otherwise follow the beat of the input
+    const bool useInternalClock = !hostHasTempo && internalClockPlaying.load();
+    if (useInternalClock)
+    {
+        if (!internalClock.isRunning())
+            internalClock.start();
+
+        currentBpm = internalBpm.load();
+        ppqPosition = internalClock.advance(buffer.getNumSamples(), currentBpm, getSampleRate());
+        isPlaying = true;
+        barStart.reset();
+    }
+    else
+    {
+        internalClock.stop();
+
+        if (!hostHasTempo)
+        {
+            beatTracker.process(analysisInput.getArrayOfReadPointers(), analysisInput.getNumChannels(),
+                                analysisInput.getNumSamples());
+            currentBpm = beatTracker.getBpm();
+            ppqPosition = beatTracker.getPpqPosition();
+            isPlaying = beatTracker.isLocked();
+            barStart.reset();
         }
     }
+    followingAudioState.store(!hostHasTempo && !useInternalClock);
+
+    // Hosts that don't report the bar start get bars counted from the song start
+    if (!barStart.has_value())
+    {
+        const double barLength = BpmSync::barLengthPpq(numerator, denominator);
+        barStart = std::floor(ppqPosition / barLength) * barLength;
+    }
+
+    // Stamp each note with the host time and PPQ of its sample, so the editor
+    // can apply it on the refresh it falls in however large the block is.
+    // MIDI passes through untouched either way.
+    if (midiTriggersEnabled.load())
+    {
+        const double sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+        const double ticksPerSample = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / sampleRate;
+        const double beatsPerSample = currentBpm / (60.0 * sampleRate);
+
+        for (const auto metadata : midiMessages)
+        {
+            const auto message = metadata.getMessage();
+            if (!message.isNoteOn())
+                continue;
+
+            if (auto trigger = MidiTrigger::fromNote(message.getNoteNumber()))
+            {
+                trigger->ticks = blockTicks + static_cast<juce::int64>(metadata.samplePosition * ticksPerSample);
+                trigger->ppqPosition = ppqPosition + metadata.samplePosition * beatsPerSample;
+                midiTriggerFifo.push(*trigger);
+            }
+        }
+    }
+
+    // Hosts apply automation between blocks, so a change belongs to the start
+    // of the block it first shows up in
+    const auto visualSettings = getVisualSettings();
+    if (visualSettings != lastBlockSettings)
+    {
+        VisualSettingsChange change;
+        change.settings = visualSettings;
+        change.ppqPosition = ppqPosition;
+        change.ticks = blockTicks;
+
+        // If the queue is full the change is retried next block
+        if (visualSettingsFifo.push(change))
+            lastBlockSettings = visualSettings;
+    }
 
     // Update atomic state for UI thread
+    transportSequence.fetch_add(1);
     bpmState.store(currentBpm);
     playingState.store(isPlaying);
     ppqState.store(ppqPosition);
+    timeSigNumeratorState.store(numerator);
+    timeSigDenominatorState.store(denominator);
+    barStartState.store(*barStart);
+    ppqTimestamp.store(blockTicks);
+    transportSequence.fetch_add(1);
+}
+
+BopperAudioProcessor::TransportSnapshot BopperAudioProcessor::getTransportSnapshot() const
+{
+    // Retry if a block was written while reading, so the fields always match
+    for (;;)
+    {
+        const auto sequence = transportSequence.load();
+
+        TransportSnapshot snapshot;
+        snapshot.bpm = bpmState.load();
+        snapshot.ppqPosition = ppqState.load();
+        snapshot.ppqTimestamp = ppqTimestamp.load();
+        snapshot.isPlaying = playingState.load();
+        snapshot.numerator = timeSigNumeratorState.load();
+        snapshot.denominator = timeSigDenominatorState.load();
+        snapshot.barStartPpq = barStartState.load();
+
+        if ((sequence & 1) == 0 && transportSequence.load() == sequence)
+            return snapshot;
+    }
 }
 
 bool BopperAudioProcessor::hasEditor() const
@@ -154,18 +364,24 @@ void BopperAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
     juce::ValueTree state("BopperState");
     state.setProperty("selectedGif", selectedGifIndex.load(), nullptr);
     state.setProperty("customGifPath", customGifPath, nullptr);
-    state.setProperty("speedDivisor", speedDivisor.load(), nullptr);
+    state.setProperty("speedDivisor", getSpeedDivisor(), nullptr);
+    state.setProperty("syncMode", static_cast<int>(getSyncMode()), nullptr);
+    state.setProperty("internalBpm", internalBpm.load(), nullptr);
 
     // Save slot paths
     for (int i = 0; i < NUM_SAVED_SLOTS; ++i)
         state.setProperty("savedGif" + juce::String(i), savedGifPaths[static_cast<size_t>(i)], nullptr);
 
     // Save effects state
-    state.setProperty("reverseEnabled", reverseEnabled.load(), nullptr);
-    state.setProperty("pingPongEnabled", pingPongEnabled.load(), nullptr);
-    state.setProperty("colorFilter", colorFilter.load(), nullptr);
-    state.setProperty("pulseEnabled", pulseEnabled.load(), nullptr);
-    state.setProperty("shakeEnabled", shakeEnabled.load(), nullptr);
+    state.setProperty("reverseEnabled", getReverseEnabled(), nullptr);
+    state.setProperty("pingPongEnabled", getPingPongEnabled(), nullptr);
+    state.setProperty("colorFilter", static_cast<int>(getColorFilter()), nullptr);
+    state.setProperty("pulseEnabled", getPulseEnabled(), nullptr);
+    state.setProperty("shakeEnabled", getShakeEnabled(), nullptr);
+    state.setProperty("reactiveEnabled", getReactiveEnabled(), nullptr);
+    state.setProperty("midiTriggersEnabled", midiTriggersEnabled.load(), nullptr);
+
+    state.appendChild(scenesToValueTree(sceneSequencer), nullptr);
 
     juce::MemoryOutputStream stream(destData, false);
     state.writeToStream(stream);
@@ -179,18 +395,89 @@ void BopperAudioProcessor::setStateInformation(const void* data, int sizeInBytes
     {
         selectedGifIndex.store(state.getProperty("selectedGif", 0));
         customGifPath = state.getProperty("customGifPath", "").toString();
-        speedDivisor.store(state.getProperty("speedDivisor", 0));
+        setSpeedDivisor(state.getProperty("speedDivisor", 0));
+        setSyncMode(static_cast<BpmSync::SyncMode>(juce::jlimit(0, BpmSync::numSyncModes - 1,
+                                                                static_cast<int>(state.getProperty("syncMode", 0)))));
+        setInternalBpm(state.getProperty("internalBpm", 120.0));
 
         for (int i = 0; i < NUM_SAVED_SLOTS; ++i)
             savedGifPaths[static_cast<size_t>(i)] = state.getProperty("savedGif" + juce::String(i), "").toString();
 
         // Load effects state
-        reverseEnabled.store(state.getProperty("reverseEnabled", false));
-        pingPongEnabled.store(state.getProperty("pingPongEnabled", false));
-        colorFilter.store(state.getProperty("colorFilter", 0));
-        pulseEnabled.store(state.getProperty("pulseEnabled", false));
-        shakeEnabled.store(state.getProperty("shakeEnabled", false));
+        setReverseEnabled(state.getProperty("reverseEnabled", false));
+        setPingPongEnabled(state.getProperty("pingPongEnabled", false));
+        setColorFilter(static_cast<ColorFilterType>(static_cast<int>(state.getProperty("colorFilter", 0))));
+        setPulseEnabled(state.getProperty("pulseEnabled", false));
+        setShakeEnabled(state.getProperty("shakeEnabled", false));
+        setReactiveEnabled(state.getProperty("reactiveEnabled", false));
+        midiTriggersEnabled.store(state.getProperty("midiTriggersEnabled", false));
+
+        // States saved before the sequencer existed have no pattern and leave it off.
+        // The editor reads the pattern on the message thread, and some hosts
+        // restore state from another thread, so it's handed over there.
+        auto scenes = scenesFromValueTree(state.getChildWithName("Scenes"));
+        if (juce::MessageManager::existsAndIsCurrentThread())
+        {
+            sceneSequencer = scenes;
+        }
+        else
+        {
+            juce::MessageManager::callAsync([processor = juce::WeakReference<BopperAudioProcessor>(this), scenes]()
+            {
+                if (processor != nullptr)
+                    processor->sceneSequencer = scenes;
+            });
+        }
+    }
+}
+
+juce::ValueTree BopperAudioProcessor::scenesToValueTree(const SceneSequencer& sequencer)
+{
+    juce::ValueTree tree("Scenes");
+    tree.setProperty("enabled", sequencer.isEnabled(), nullptr);
+    tree.setProperty("stepLength", static_cast<int>(sequencer.getStepLength()), nullptr);
+    tree.setProperty("numSteps", sequencer.getNumSteps(), nullptr);
+
+    for (int i = 0; i < sequencer.getNumSteps(); ++i)
+    {
+        const auto& scene = sequencer.getStep(i);
+        juce::ValueTree step("Step");
+        step.setProperty("gif", scene.gif, nullptr);
+        step.setProperty("filter", static_cast<int>(scene.filter), nullptr);
+        step.setProperty("speedDivisor", scene.speedDivisor, nullptr);
+        step.setProperty("reverse", scene.reverse, nullptr);
+        step.setProperty("pingPong", scene.pingPong, nullptr);
+        tree.appendChild(step, nullptr);
     }
+
+    return tree;
+}
+
+SceneSequencer BopperAudioProcessor::scenesFromValueTree(const juce::ValueTree& tree)
+{
+    SceneSequencer sequencer;
+    if (!tree.isValid())
+        return sequencer;
+
+    sequencer.setEnabled(tree.getProperty("enabled", false));
+    sequencer.setStepLength(static_cast<int>(tree.getProperty("stepLength", 1)) == 0 ? SceneSequencer::StepLength::Beat
+                                                                                     : SceneSequencer::StepLength::Bar);
+    sequencer.setNumSteps(tree.getProperty("numSteps", 4));
+
+    for (int i = 0; i < juce::jmin(tree.getNumChildren(), SceneSequencer::maxSteps); ++i)
+    {
+        const auto step = tree.getChild(i);
+        auto& scene = sequencer.getStep(i);
+        scene.gif = juce::jlimit(Scene::keepGif, Scene::numGifs - 1, static_cast<int>(step.getProperty("gif", Scene::keepGif)));
+        scene.filter = static_cast<ColorFilterType>(juce::jlimit(0, ColorFilter::numFilters - 1,
+                                                                 static_cast<int>(step.getProperty("filter", 0))));
+        scene.speedDivisor = juce::jlimit(minSpeedDivisor, maxSpeedDivisor,
+                                          static_cast<int>(step.getProperty("speedDivisor", 0)));
+        scene.reverse = step.getProperty("reverse", false);
+        scene.pingPong = step.getProperty("pingPong", false);
+    }
+
+    return sequencer;
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
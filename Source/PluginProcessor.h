@@ -3,17 +3,15 @@
 #include <JuceHeader.h>
 #include <atomic>
 #include <array>
-
-// Effect types
-enum class ColorFilterType
-{
-    None = 0,
-    Invert,
-    Sepia,
-    Cyberpunk,  // Cyan/pink tint
-    Vaporwave,  // Purple/pink tint
-    Matrix      // Green tint
-};
+#include "Utils/AudioAnalysis.h"
+#include "Utils/BeatTracker.h"
+#include "Utils/BpmSync.h"
+#include "Utils/ColorFilter.h"
+#include "Utils/InternalClock.h"
+#include "Utils/LockFreeQueue.h"
+#include "Utils/MidiTriggers.h"
+#include "Utils/SceneSequencer.h"
+#include "Utils/PerformanceMetrics.h"
 
 class BopperAudioProcessor : public juce::AudioProcessor
 {
@@ -52,6 +50,50 @@ public:
     double getPpqPosition() const { return ppqState.load(); }
     bool isHostPlaying() const { return playingState.load(); }
 
+    // Host time signature and the PPQ position where the current bar started
+    int getTimeSigNumerator() const { return timeSigNumeratorState.load(); }
+    int getTimeSigDenominator() const { return timeSigDenominatorState.load(); }
+    double getBarStartPpq() const { return barStartState.load(); }
+
+    // True when the tempo and position come from the beat tracker, not the host
+    bool isFollowingAudio() const { return followingAudioState.load(); }
+
+    // Internal transport, used while playing when the host reports no tempo
+    // (the Standalone app). Otherwise the beat tracker follows the input.
+    static constexpr double minInternalBpm = 20.0;
+    static constexpr double maxInternalBpm = 300.0;
+    void setInternalBpm(double bpm) { internalBpm.store(juce::jlimit(minInternalBpm, maxInternalBpm, bpm)); }
+    double getInternalBpm() const { return internalBpm.load(); }
+
+    void setInternalClockPlaying(bool playing) { internalClockPlaying.store(playing); }
+    bool isInternalClockPlaying() const { return internalClockPlaying.load(); }
+
+    // High resolution tick count at which the PPQ position was last updated
+    juce::int64 getPpqTimestamp() const { return ppqTimestamp.load(); }
+
+    // Tempo, position, time signature and timestamp all from the same audio block
+    struct TransportSnapshot
+    {
+        double bpm = 120.0;
+        double ppqPosition = 0.0;
+        juce::int64 ppqTimestamp = 0;
+        bool isPlaying = false;
+        int numerator = 4;
+        int denominator = 4;
+        double barStartPpq = 0.0;
+    };
+
+    TransportSnapshot getTransportSnapshot() const;
+
+    // Input levels of each block, for the audio-reactive effects (read on the message thread)
+    AudioLevelsFifo& getAudioLevelsFifo() { return audioLevelsFifo; }
+
+    // Note-on triggers stamped with the time they sound (read on the message thread)
+    MidiTriggerFifo& getMidiTriggerFifo() { return midiTriggerFifo; }
+
+    // Live figures for the editor's performance HUD
+    PerformanceMetrics& getMetrics() { return metrics; }
+
     // Selected GIF state
     void setSelectedGifIndex(int index) { selectedGifIndex.store(index); }
     int getSelectedGifIndex() const { return selectedGifIndex.load(); }
@@ -59,46 +101,147 @@ public:
     void setCustomGifPath(const juce::String& path) { customGifPath = path; }
     juce::String getCustomGifPath() const { return customGifPath; }
 
-    // Speed divisor (0 = 1x, 1 = 1/2, 2 = 1/4, 3 = 1/8, 4 = 1/16)
-    void setSpeedDivisor(int divisor) { speedDivisor.store(divisor); }
-    int getSpeedDivisor() const { return speedDivisor.load(); }
+    // Speed divisor (-2 = 4x, -1 = 2x, 0 = 1x, 1 = 1/2, 2 = 1/4, 3 = 1/8, 4 = 1/16)
+    static constexpr int minSpeedDivisor = BpmSync::LoopSettings::minSpeedIndex;
+    static constexpr int maxSpeedDivisor = BpmSync::LoopSettings::maxSpeedIndex;
 
     // Saved GIFs (3 slots)
     static constexpr int NUM_SAVED_SLOTS = 3;
     void setSavedGifPath(int slot, const juce::String& path);
     juce::String getSavedGifPath(int slot) const;
 
-    // Effects
-    void setReverseEnabled(bool enabled) { reverseEnabled.store(enabled); }
-    bool getReverseEnabled() const { return reverseEnabled.load(); }
+    // Pattern of scenes played along with the transport (message thread only)
+    SceneSequencer& getSceneSequencer() { return sceneSequencer; }
 
-    void setPingPongEnabled(bool enabled) { pingPongEnabled.store(enabled); }
-    bool getPingPongEnabled() const { return pingPongEnabled.load(); }
+    // The visual controls are host parameters, so they can be automated. The
+    // setters notify the host; the getters are lock free.
+    struct ParameterIds
+    {
+        static constexpr const char* speed = "speed";
+        static constexpr const char* syncMode = "syncMode";
+        static constexpr const char* reverse = "reverse";
+        static constexpr const char* pingPong = "pingPong";
+        static constexpr const char* colorFilter = "colorFilter";
+        static constexpr const char* pulse = "pulse";
+        static constexpr const char* shake = "shake";
+        static constexpr const char* reactive = "reactive";
+    };
 
-    void setColorFilter(ColorFilterType filter) { colorFilter.store(static_cast<int>(filter)); }
-    ColorFilterType getColorFilter() const { return static_cast<ColorFilterType>(colorFilter.load()); }
+    juce::AudioProcessorValueTreeState& getParameters() { return parameters; }
 
-    void setPulseEnabled(bool enabled) { pulseEnabled.store(enabled); }
-    bool getPulseEnabled() const { return pulseEnabled.load(); }
+    void setSpeedDivisor(int divisor) { setParameter(ParameterIds::speed, static_cast<float>(divisor)); }
+    int getSpeedDivisor() const { return juce::roundToInt(speedValue->load()); }
 
-    void setShakeEnabled(bool enabled) { shakeEnabled.store(enabled); }
-    bool getShakeEnabled() const { return shakeEnabled.load(); }
+    // What one loop of the GIF spans
+    void setSyncMode(BpmSync::SyncMode mode) { setParameter(ParameterIds::syncMode, static_cast<float>(mode)); }
+    BpmSync::SyncMode getSyncMode() const { return static_cast<BpmSync::SyncMode>(juce::roundToInt(syncModeValue->load())); }
+
+    // Effects
+    void setReverseEnabled(bool enabled) { setParameter(ParameterIds::reverse, enabled ? 1.0f : 0.0f); }
+    bool getReverseEnabled() const { return reverseValue->load() >= 0.5f; }
+
+    void setPingPongEnabled(bool enabled) { setParameter(ParameterIds::pingPong, enabled ? 1.0f : 0.0f); }
+    bool getPingPongEnabled() const { return pingPongValue->load() >= 0.5f; }
+
+    void setColorFilter(ColorFilterType filter) { setParameter(ParameterIds::colorFilter, static_cast<float>(filter)); }
+    ColorFilterType getColorFilter() const { return static_cast<ColorFilterType>(juce::roundToInt(colorFilterValue->load())); }
+
+    void setPulseEnabled(bool enabled) { setParameter(ParameterIds::pulse, enabled ? 1.0f : 0.0f); }
+    bool getPulseEnabled() const { return pulseValue->load() >= 0.5f; }
+
+    void setShakeEnabled(bool enabled) { setParameter(ParameterIds::shake, enabled ? 1.0f : 0.0f); }
+    bool getShakeEnabled() const { return shakeValue->load() >= 0.5f; }
+
+    // Pulse, shake and filter mix follow the input level instead of the beat phase
+    void setReactiveEnabled(bool enabled) { setParameter(ParameterIds::reactive, enabled ? 1.0f : 0.0f); }
+    bool getReactiveEnabled() const { return reactiveValue->load() >= 0.5f; }
+
+    // All of the visual controls at once
+    struct VisualSettings
+    {
+        int speedDivisor = 0;
+        BpmSync::SyncMode syncMode = BpmSync::SyncMode::Beat;
+        bool reverse = false;
+        bool pingPong = false;
+        ColorFilterType colorFilter = ColorFilterType::None;
+        bool pulse = false;
+        bool shake = false;
+        bool reactive = false;
+
+        bool operator==(const VisualSettings& other) const;
+        bool operator!=(const VisualSettings& other) const { return !(*this == other); }
+    };
+
+    VisualSettings getVisualSettings() const;
+
+    // Settings as changed by the host or the editor, with the PPQ and time of
+    // the block the change arrived in, so the editor applies them on that beat
+    struct VisualSettingsChange
+    {
+        VisualSettings settings;
+        double ppqPosition = 0.0;
+        juce::int64 ticks = 0;
+    };
+
+    using VisualSettingsFifo = LockFreeQueue<VisualSettingsChange, 64>;
+    VisualSettingsFifo& getVisualSettingsFifo() { return visualSettingsFifo; }
+
+    // MIDI notes retrigger the loop, jump to frames or switch GIFs (see MidiTrigger)
+    void setMidiTriggersEnabled(bool enabled) { midiTriggersEnabled.store(enabled); }
+    bool getMidiTriggersEnabled() const { return midiTriggersEnabled.load(); }
 
 private:
     std::atomic<double> bpmState{120.0};
     std::atomic<double> ppqState{0.0};
     std::atomic<bool> playingState{false};
+    std::atomic<juce::int64> ppqTimestamp{0};
+    std::atomic<int> timeSigNumeratorState{4};
+    std::atomic<int> timeSigDenominatorState{4};
+    std::atomic<double> barStartState{0.0};
+    std::atomic<bool> followingAudioState{false};
+
+    // Odd while processBlock is writing the transport state above
+    std::atomic<juce::uint32> transportSequence{0};
+
+    // Follows the input when the host has no tempo (audio thread only)
+    BeatTracker beatTracker;
+    InternalClock internalClock;
+    std::atomic<double> internalBpm{120.0};
+    std::atomic<bool> internalClockPlaying{false};
+    AudioAnalyser audioAnalyser;
+    AudioLevelsFifo audioLevelsFifo;
+    MidiTriggerFifo midiTriggerFifo;
+    PerformanceMetrics metrics;
     std::atomic<int> selectedGifIndex{0};
-    std::atomic<int> speedDivisor{0};
     juce::String customGifPath;
     std::array<juce::String, NUM_SAVED_SLOTS> savedGifPaths;
-
-    // Effects state
-    std::atomic<bool> reverseEnabled{false};
-    std::atomic<bool> pingPongEnabled{false};
-    std::atomic<int> colorFilter{0};
-    std::atomic<bool> pulseEnabled{false};
-    std::atomic<bool> shakeEnabled{false};
-
+    SceneSequencer sceneSequencer;
+    std::atomic<bool> midiTriggersEnabled{false};
+
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    // The scene pattern as a "Scenes" child of the saved state. Kept here, not
+    // in SceneSequencer, so the headless core needs no juce_data_structures.
+    static juce::ValueTree scenesToValueTree(const SceneSequencer& sequencer);
+    static SceneSequencer scenesFromValueTree(const juce::ValueTree& tree);
+    void setParameter(const char* parameterId, float value);
+
+    juce::AudioProcessorValueTreeState parameters;
+
+    // Plain values of the parameters, read without locking
+    std::atomic<float>* speedValue = nullptr;
+    std::atomic<float>* syncModeValue = nullptr;
+    std::atomic<float>* reverseValue = nullptr;
+    std::atomic<float>* pingPongValue = nullptr;
+    std::atomic<float>* colorFilterValue = nullptr;
+    std::atomic<float>* pulseValue = nullptr;
+    std::atomic<float>* shakeValue = nullptr;
+    std::atomic<float>* reactiveValue = nullptr;
+
+    // Settings of the previous block, for spotting changes (audio thread only)
+    VisualSettings lastBlockSettings;
+    VisualSettingsFifo visualSettingsFifo;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(BopperAudioProcessor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BopperAudioProcessor)
 };
@@ -1,4 +1,61 @@
 #include "BopperLookAndFeel.h"
+#include "Utils/TraceRecorder.h"
+
+namespace
+{
+    enum ChromeKind
+    {
+        buttonChrome = 0,
+        comboBoxChrome,
+        sliderTrackChrome,
+        sliderThumbChrome
+    };
+
+    // Sizes only change on layout or when the window moves to another display
+    constexpr size_t maxCachedChrome = 256;
+
+    constexpr float sliderThumbRadius = 8.0f;
+    constexpr float sliderThumbGlow = 3.0f;
+}
+
+// Adds the duration of one draw call to the component's paint cost
+class BopperLookAndFeel::ScopedPaintCost
+{
+public:
+    ScopedPaintCost(BopperLookAndFeel& lookAndFeel, const char* kind, const juce::Component& component)
+        : owner(lookAndFeel), kindName(kind), target(component),
+          active(lookAndFeel.paintProfilingEnabled),
+          startTicks(active ? juce::Time::getHighResolutionTicks() : 0)
+    {
+    }
+
+    ~ScopedPaintCost()
+    {
+        if (!active)
+            return;
+
+        double ms = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+        auto name = target.getName();
+        if (name.isEmpty())
+            if (auto* button = dynamic_cast<const juce::Button*>(&target))
+                name = button->getButtonText();
+
+        name = juce::String(kindName) + " " + name;
+        auto& cost = owner.paintCosts[name];
+        cost.name = name;
+        cost.calls += 1;
+        cost.totalMs += ms;
+        cost.worstMs = juce::jmax(cost.worstMs, ms);
+    }
+
+private:
+    BopperLookAndFeel& owner;
+    const char* kindName;
+    const juce::Component& target;
+    const bool active;
+    const juce::int64 startTicks;
+};
 
 BopperLookAndFeel::BopperLookAndFeel()
 {
@@ -21,66 +78,81 @@ void BopperLookAndFeel::drawButtonBackground(juce::Graphics& g, juce::Button& bu
                                                bool shouldDrawButtonAsHighlighted,
                                                bool shouldDrawButtonAsDown)
 {
-    auto bounds = button.getLocalBounds().toFloat().reduced(1.0f);
-    auto cornerSize = 6.0f;
-
-    // Determine button state colors
-    juce::Colour baseColour = Colors::surface;
-    juce::Colour glowColour = Colors::neonCyan.withAlpha(0.0f);
-
-    if (shouldDrawButtonAsDown)
-    {
-        baseColour = Colors::surfaceBright;
-        glowColour = Colors::neonCyan.withAlpha(0.4f);
-    }
-    else if (shouldDrawButtonAsHighlighted)
-    {
-        baseColour = Colors::surfaceLight;
-        glowColour = Colors::neonCyan.withAlpha(0.2f);
-    }
-    else if (button.getToggleState())
-    {
-        baseColour = Colors::surfaceBright;
-        glowColour = Colors::neonPink.withAlpha(0.3f);
-    }
+    BOPPER_TRACE_SCOPE("LookAndFeel::drawButtonBackground");
+    const ScopedPaintCost paintCost(*this, "Button", button);
 
-    // Draw glow effect for active/highlighted states
-    if (glowColour.getAlpha() > 0)
-    {
-        g.setColour(glowColour);
-        g.fillRoundedRectangle(bounds.expanded(2.0f), cornerSize + 2.0f);
-    }
+    const bool toggled = button.getToggleState();
+    const ChromeKey key{buttonChrome, button.getWidth(), button.getHeight(),
+                        (shouldDrawButtonAsDown ? 1 : 0) | (shouldDrawButtonAsHighlighted ? 2 : 0) | (toggled ? 4 : 0),
+                        g.getInternalContext().getPhysicalPixelScaleFactor()};
 
-    // Main button background
-    g.setColour(baseColour);
-    g.fillRoundedRectangle(bounds, cornerSize);
+    auto area = button.getLocalBounds().toFloat();
 
-    // Border with potential glow
-    if (button.getToggleState() || shouldDrawButtonAsDown)
+    drawChrome(g, key, area, [=](juce::Graphics& g)
     {
-        g.setColour(Colors::neonCyan.withAlpha(0.8f));
-    }
-    else if (shouldDrawButtonAsHighlighted)
-    {
-        g.setColour(Colors::neonCyan.withAlpha(0.5f));
-    }
-    else
-    {
-        g.setColour(Colors::border);
-    }
-    g.drawRoundedRectangle(bounds, cornerSize, 1.0f);
-
-    // Inner highlight line at top for depth
-    g.setColour(juce::Colours::white.withAlpha(0.05f));
-    g.drawHorizontalLine(static_cast<int>(bounds.getY() + 2),
-                         bounds.getX() + cornerSize,
-                         bounds.getRight() - cornerSize);
+        auto bounds = area.withZeroOrigin().reduced(1.0f);
+        auto cornerSize = 6.0f;
+
+        // Determine button state colors
+        juce::Colour baseColour = Colors::surface;
+        juce::Colour glowColour = Colors::neonCyan.withAlpha(0.0f);
+
+        if (shouldDrawButtonAsDown)
+        {
+            baseColour = Colors::surfaceBright;
+            glowColour = Colors::neonCyan.withAlpha(0.4f);
+        }
+        else if (shouldDrawButtonAsHighlighted)
+        {
+            baseColour = Colors::surfaceLight;
+            glowColour = Colors::neonCyan.withAlpha(0.2f);
+        }
+        else if (toggled)
+        {
+            baseColour = Colors::surfaceBright;
+            glowColour = Colors::neonPink.withAlpha(0.3f);
+        }
+
+        // Draw glow effect for active/highlighted states
+        if (glowColour.getAlpha() > 0)
+        {
+            g.setColour(glowColour);
+            g.fillRoundedRectangle(bounds.expanded(2.0f), cornerSize + 2.0f);
+        }
+
+        // Main button background
+        g.setColour(baseColour);
+        g.fillRoundedRectangle(bounds, cornerSize);
+
+        // Border with potential glow
+        if (toggled || shouldDrawButtonAsDown)
+        {
+            g.setColour(Colors::neonCyan.withAlpha(0.8f));
+        }
+        else if (shouldDrawButtonAsHighlighted)
+        {
+            g.setColour(Colors::neonCyan.withAlpha(0.5f));
+        }
+        else
+        {
+            g.setColour(Colors::border);
+        }
+        g.drawRoundedRectangle(bounds, cornerSize, 1.0f);
+
+        // Inner highlight line at top for depth
+        g.setColour(juce::Colours::white.withAlpha(0.05f));
+        g.drawHorizontalLine(static_cast<int>(bounds.getY() + 2),
+                             bounds.getX() + cornerSize,
+                             bounds.getRight() - cornerSize);
+    });
 }
 
 void BopperLookAndFeel::drawButtonText(juce::Graphics& g, juce::TextButton& button,
                                          bool shouldDrawButtonAsHighlighted,
                                          bool shouldDrawButtonAsDown)
 {
+    const ScopedPaintCost paintCost(*this, "ButtonText", button);
+
     auto font = getTextButtonFont(button, button.getHeight());
     g.setFont(font);
 
@@ -105,16 +177,23 @@ void BopperLookAndFeel::drawLinearSlider(juce::Graphics& g, int x, int y, int wi
                                           float sliderPos, float minSliderPos, float maxSliderPos,
                                           juce::Slider::SliderStyle style, juce::Slider& slider)
 {
+    BOPPER_TRACE_SCOPE("LookAndFeel::drawLinearSlider");
+    const ScopedPaintCost paintCost(*this, "Slider", slider);
+
     auto trackWidth = 6.0f;
     auto bounds = juce::Rectangle<float>(static_cast<float>(x), static_cast<float>(y),
                                           static_cast<float>(width), static_cast<float>(height));
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
 
     // Track background
     auto trackBounds = bounds.withSizeKeepingCentre(bounds.getWidth(), trackWidth);
-    g.setColour(Colors::sliderTrack);
-    g.fillRoundedRectangle(trackBounds, trackWidth / 2.0f);
+    drawChrome(g, {sliderTrackChrome, width, height, 0, scale}, bounds, [=](juce::Graphics& g)
+    {
+        g.setColour(Colors::sliderTrack);
+        g.fillRoundedRectangle(trackBounds - bounds.getPosition(), trackWidth / 2.0f);
+    });
 
-    // Active track (filled portion)
+    // Active track (filled portion) - follows the value, so always drawn live
     auto fillWidth = sliderPos - static_cast<float>(x);
     if (fillWidth > 0)
     {
@@ -131,47 +210,64 @@ void BopperLookAndFeel::drawLinearSlider(juce::Graphics& g, int x, int y, int wi
         g.fillRoundedRectangle(fillBounds.expanded(2.0f), trackWidth / 2.0f + 2.0f);
     }
 
-    // Thumb
-    auto thumbRadius = 8.0f;
-    auto thumbX = sliderPos - thumbRadius;
-    auto thumbY = bounds.getCentreY() - thumbRadius;
+    // Thumb, including its glow
+    const float thumbSize = (sliderThumbRadius + sliderThumbGlow) * 2.0f;
+    auto thumbArea = juce::Rectangle<float>(thumbSize, thumbSize)
+                         .withCentre({sliderPos, bounds.getCentreY()});
+    const int thumbPixels = static_cast<int>(thumbSize);
 
-    // Thumb glow
-    g.setColour(Colors::neonCyan.withAlpha(0.4f));
-    g.fillEllipse(thumbX - 3.0f, thumbY - 3.0f, thumbRadius * 2.0f + 6.0f, thumbRadius * 2.0f + 6.0f);
+    drawChrome(g, {sliderThumbChrome, thumbPixels, thumbPixels, 0, scale}, thumbArea, [](juce::Graphics& g)
+    {
+        auto thumbRadius = sliderThumbRadius;
+        auto thumbX = sliderThumbGlow;
+        auto thumbY = sliderThumbGlow;
 
-    // Thumb body
-    g.setColour(Colors::neonCyan);
-    g.fillEllipse(thumbX, thumbY, thumbRadius * 2.0f, thumbRadius * 2.0f);
+        // Thumb glow
+        g.setColour(Colors::neonCyan.withAlpha(0.4f));
+        g.fillEllipse(thumbX - 3.0f, thumbY - 3.0f, thumbRadius * 2.0f + 6.0f, thumbRadius * 2.0f + 6.0f);
 
-    // Thumb inner highlight
-    g.setColour(juce::Colours::white.withAlpha(0.5f));
-    g.fillEllipse(thumbX + 3.0f, thumbY + 2.0f, thumbRadius - 2.0f, thumbRadius - 2.0f);
+        // Thumb body
+        g.setColour(Colors::neonCyan);
+        g.fillEllipse(thumbX, thumbY, thumbRadius * 2.0f, thumbRadius * 2.0f);
+
+        // Thumb inner highlight
+        g.setColour(juce::Colours::white.withAlpha(0.5f));
+        g.fillEllipse(thumbX + 3.0f, thumbY + 2.0f, thumbRadius - 2.0f, thumbRadius - 2.0f);
+    });
 }
 
 void BopperLookAndFeel::drawComboBox(juce::Graphics& g, int width, int height, bool isButtonDown,
                                       int buttonX, int buttonY, int buttonW, int buttonH,
                                       juce::ComboBox& box)
 {
-    auto bounds = juce::Rectangle<float>(0, 0, static_cast<float>(width), static_cast<float>(height));
-    auto cornerSize = 6.0f;
+    BOPPER_TRACE_SCOPE("LookAndFeel::drawComboBox");
+    const ScopedPaintCost paintCost(*this, "ComboBox", box);
 
-    // Background
-    g.setColour(isButtonDown ? Colors::surfaceBright : Colors::surface);
-    g.fillRoundedRectangle(bounds.reduced(1.0f), cornerSize);
+    auto bounds = juce::Rectangle<float>(0, 0, static_cast<float>(width), static_cast<float>(height));
+    const ChromeKey key{comboBoxChrome, width, height, isButtonDown ? 1 : 0,
+                        g.getInternalContext().getPhysicalPixelScaleFactor()};
 
-    // Border
-    g.setColour(isButtonDown ? Colors::neonCyan : Colors::border);
-    g.drawRoundedRectangle(bounds.reduced(1.0f), cornerSize, 1.0f);
-
-    // Arrow
-    auto arrowZone = juce::Rectangle<float>(static_cast<float>(width - 20), 0, 15.0f, static_cast<float>(height));
-    juce::Path arrow;
-    arrow.addTriangle(arrowZone.getCentreX() - 4.0f, arrowZone.getCentreY() - 2.0f,
-                      arrowZone.getCentreX() + 4.0f, arrowZone.getCentreY() - 2.0f,
-                      arrowZone.getCentreX(), arrowZone.getCentreY() + 4.0f);
-    g.setColour(Colors::neonCyan);
-    g.fillPath(arrow);
+    drawChrome(g, key, bounds, [=](juce::Graphics& g)
+    {
+        auto cornerSize = 6.0f;
+
+        // Background
+        g.setColour(isButtonDown ? Colors::surfaceBright : Colors::surface);
+        g.fillRoundedRectangle(bounds.reduced(1.0f), cornerSize);
+
+        // Border
+        g.setColour(isButtonDown ? Colors::neonCyan : Colors::border);
+        g.drawRoundedRectangle(bounds.reduced(1.0f), cornerSize, 1.0f);
+
+        // Arrow
+        auto arrowZone = juce::Rectangle<float>(static_cast<float>(width - 20), 0, 15.0f, static_cast<float>(height));
+        juce::Path arrow;
+        arrow.addTriangle(arrowZone.getCentreX() - 4.0f, arrowZone.getCentreY() - 2.0f,
+                          arrowZone.getCentreX() + 4.0f, arrowZone.getCentreY() - 2.0f,
+                          arrowZone.getCentreX(), arrowZone.getCentreY() + 4.0f);
+        g.setColour(Colors::neonCyan);
+        g.fillPath(arrow);
+    });
 }
 
 void BopperLookAndFeel::drawPopupMenuBackground(juce::Graphics& g, int width, int height)
@@ -257,3 +353,65 @@ juce::Font BopperLookAndFeel::getTechFont(float size)
 {
     return juce::Font("Avenir Next", size, juce::Font::plain).withExtraKerningFactor(0.05f);
 }
+
+void BopperLookAndFeel::setChromeCacheEnabled(bool shouldCache)
+{
+    chromeCacheEnabled = shouldCache;
+    chromeCache.clear();
+}
+
+void BopperLookAndFeel::setPaintProfilingEnabled(bool shouldProfile)
+{
+    paintProfilingEnabled = shouldProfile;
+}
+
+std::vector<BopperLookAndFeel::PaintCost> BopperLookAndFeel::getPaintCosts() const
+{
+    std::vector<PaintCost> costs;
+    for (const auto& entry : paintCosts)
+        costs.push_back(entry.second);
+
+    std::sort(costs.begin(), costs.end(), [](const PaintCost& a, const PaintCost& b)
+    {
+        return a.totalMs > b.totalMs;
+    });
+    return costs;
+}
+
+void BopperLookAndFeel::drawChrome(juce::Graphics& g, const ChromeKey& key, juce::Rectangle<float> area,
+                                   const std::function<void(juce::Graphics&)>& paintChrome)
+{
+    if (!chromeCacheEnabled || area.isEmpty())
+    {
+        juce::Graphics::ScopedSaveState state(g);
+        g.addTransform(juce::AffineTransform::translation(area.getX(), area.getY()));
+        paintChrome(g);
+        return;
+    }
+
+    auto cached = chromeCache.find(key);
+    if (cached == chromeCache.end())
+    {
+        if (chromeCache.size() >= maxCachedChrome)
+            chromeCache.clear();
+
+        // Rendered at the physical pixel size so the blit is 1:1
+        juce::Image image(juce::Image::ARGB,
+                          juce::jmax(1, juce::roundToInt(area.getWidth() * key.scale)),
+                          juce::jmax(1, juce::roundToInt(area.getHeight() * key.scale)),
+                          true);
+        {
+            juce::Graphics imageGraphics(image);
+            imageGraphics.addTransform(juce::AffineTransform::scale(key.scale));
+            paintChrome(imageGraphics);
+        }
+        cached = chromeCache.emplace(key, image).first;
+    }
+
+    // Snap to the physical pixel grid so the blit isn't resampled
+    area.setPosition(std::round(area.getX() * key.scale) / key.scale,
+                     std::round(area.getY() * key.scale) / key.scale);
+
+    g.setOpacity(1.0f);
+    g.drawImage(cached->second, area);
+}
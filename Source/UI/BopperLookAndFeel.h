@@ -1,6 +1,10 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
 
 class BopperLookAndFeel : public juce::LookAndFeel_V4
 {
@@ -66,4 +70,53 @@ public:
 
     // Custom tech font for labels
     static juce::Font getTechFont(float size);
+
+    // Cached chrome: static control visuals (button and combo box backgrounds,
+    // slider track and thumb) are rendered once per size, state and display
+    // scale and blitted afterwards. On by default.
+    void setChromeCacheEnabled(bool shouldCache);
+    bool isChromeCacheEnabled() const { return chromeCacheEnabled; }
+
+    // Time every control draw call made through this look and feel. Button
+    // background and text are separate draw calls, kept as separate kinds.
+    struct PaintCost
+    {
+        juce::String name;
+        int calls = 0;
+        double totalMs = 0.0;
+        double worstMs = 0.0;
+    };
+
+    void setPaintProfilingEnabled(bool shouldProfile);
+    bool isPaintProfilingEnabled() const { return paintProfilingEnabled; }
+    void resetPaintCosts() { paintCosts.clear(); }
+
+    // Most expensive first
+    std::vector<PaintCost> getPaintCosts() const;
+
+private:
+    class ScopedPaintCost;
+
+    struct ChromeKey
+    {
+        int kind, width, height, state;
+        float scale;
+
+        bool operator<(const ChromeKey& other) const
+        {
+            return std::tie(kind, width, height, state, scale)
+                 < std::tie(other.kind, other.width, other.height, other.state, other.scale);
+        }
+    };
+
+    // Draw the chrome for key at area, from the cache when enabled.
+    // paintChrome draws in logical coordinates relative to the area's origin.
+    void drawChrome(juce::Graphics& g, const ChromeKey& key, juce::Rectangle<float> area,
+                    const std::function<void(juce::Graphics&)>& paintChrome);
+
+    bool chromeCacheEnabled = true;
+    std::map<ChromeKey, juce::Image> chromeCache;
+
+    bool paintProfilingEnabled = false;
+    std::map<juce::String, PaintCost> paintCosts;
 };
@@ -1,9 +1,11 @@
 #include "GifDisplayComponent.h"
 #include "UI/BopperLookAndFeel.h"
+#include "Utils/TraceRecorder.h"
 
 GifDisplayComponent::GifDisplayComponent()
 {
-    setOpaque(false);
+    // Opaque so the 60 Hz repaint never has to redraw the editor behind it
+    setOpaque(true);
 }
 
 void GifDisplayComponent::setEffects(ColorFilterType filter, bool pulse, bool shake, double beatPhase)
@@ -14,122 +16,22 @@ void GifDisplayComponent::setEffects(ColorFilterType filter, bool pulse, bool sh
     currentBeatPhase = beatPhase;
 }
 
-juce::Image GifDisplayComponent::applyColorFilter(const juce::Image& source, ColorFilterType filter)
+void GifDisplayComponent::setAudioReactive(bool enabled, const AudioLevels& envelope)
 {
-    if (filter == ColorFilterType::None)
-        return source;
-
-    juce::Image filtered = source.createCopy();
-    juce::Image::BitmapData data(filtered, juce::Image::BitmapData::readWrite);
-
-    for (int y = 0; y < data.height; ++y)
-    {
-        for (int x = 0; x < data.width; ++x)
-        {
-            juce::Colour pixel = data.getPixelColour(x, y);
-
-            if (pixel.getAlpha() == 0)
-                continue;
-
-            juce::Colour newPixel;
-
-            switch (filter)
-            {
-                case ColorFilterType::Invert:
-                    newPixel = juce::Colour(
-                        static_cast<juce::uint8>(255 - pixel.getRed()),
-                        static_cast<juce::uint8>(255 - pixel.getGreen()),
-                        static_cast<juce::uint8>(255 - pixel.getBlue()),
-                        pixel.getAlpha());
-                    break;
-
-                case ColorFilterType::Sepia:
-                {
-                    float r = static_cast<float>(pixel.getRed());
-                    float g = static_cast<float>(pixel.getGreen());
-                    float b = static_cast<float>(pixel.getBlue());
-
-                    int newR = static_cast<int>(std::min(255.0f, r * 0.393f + g * 0.769f + b * 0.189f));
-                    int newG = static_cast<int>(std::min(255.0f, r * 0.349f + g * 0.686f + b * 0.168f));
-                    int newB = static_cast<int>(std::min(255.0f, r * 0.272f + g * 0.534f + b * 0.131f));
-
-                    newPixel = juce::Colour(
-                        static_cast<juce::uint8>(newR),
-                        static_cast<juce::uint8>(newG),
-                        static_cast<juce::uint8>(newB),
-                        pixel.getAlpha());
-                    break;
-                }
-
-                case ColorFilterType::Cyberpunk:
-                {
-                    // Cyan/pink tint - boost cyan and pink channels
-                    float r = static_cast<float>(pixel.getRed());
-                    float g = static_cast<float>(pixel.getGreen());
-                    float b = static_cast<float>(pixel.getBlue());
-
-                    // Shift toward cyan (boost G and B) and pink (boost R)
-                    int newR = static_cast<int>(std::min(255.0f, r * 1.1f + 20.0f));
-                    int newG = static_cast<int>(std::min(255.0f, g * 0.9f + b * 0.2f));
-                    int newB = static_cast<int>(std::min(255.0f, b * 1.2f + 30.0f));
-
-                    newPixel = juce::Colour(
-                        static_cast<juce::uint8>(newR),
-                        static_cast<juce::uint8>(newG),
-                        static_cast<juce::uint8>(newB),
-                        pixel.getAlpha());
-                    break;
-                }
-
-                case ColorFilterType::Vaporwave:
-                {
-                    // Purple/pink aesthetic
-                    float r = static_cast<float>(pixel.getRed());
-                    float g = static_cast<float>(pixel.getGreen());
-                    float b = static_cast<float>(pixel.getBlue());
-
-                    // Shift toward purple/magenta
-                    int newR = static_cast<int>(std::min(255.0f, r * 1.0f + b * 0.3f + 20.0f));
-                    int newG = static_cast<int>(std::min(255.0f, g * 0.6f));
-                    int newB = static_cast<int>(std::min(255.0f, b * 1.1f + r * 0.2f + 40.0f));
-
-                    newPixel = juce::Colour(
-                        static_cast<juce::uint8>(newR),
-                        static_cast<juce::uint8>(newG),
-                        static_cast<juce::uint8>(newB),
-                        pixel.getAlpha());
-                    break;
-                }
-
-                case ColorFilterType::Matrix:
-                {
-                    // Green terminal style
-                    float luma = pixel.getRed() * 0.299f + pixel.getGreen() * 0.587f + pixel.getBlue() * 0.114f;
-
-                    newPixel = juce::Colour(
-                        static_cast<juce::uint8>(luma * 0.2f),
-                        static_cast<juce::uint8>(std::min(255.0f, luma * 1.2f)),
-                        static_cast<juce::uint8>(luma * 0.3f),
-                        pixel.getAlpha());
-                    break;
-                }
-
-                default:
-                    newPixel = pixel;
-                    break;
-            }
-
-            data.setPixelColour(x, y, newPixel);
-        }
-    }
-
-    return filtered;
+    audioReactive = enabled;
+    audioEnvelope = envelope;
 }
 
 void GifDisplayComponent::paint(juce::Graphics& g)
 {
+    BOPPER_TRACE_SCOPE("GifDisplayComponent::paint");
+    const auto paintStart = juce::Time::getHighResolutionTicks();
+
     auto bounds = getLocalBounds().toFloat();
 
+    // Fill the corners outside the rounded panel with the editor background
+    g.fillAll(BopperLookAndFeel::Colors::background);
+
     // Draw background with rounded corners
     g.setColour(BopperLookAndFeel::Colors::surfaceLight);
     g.fillRoundedRectangle(bounds, 12.0f);
@@ -140,14 +42,6 @@ void GifDisplayComponent::paint(juce::Graphics& g)
 
     if (gifAnimator != nullptr && gifAnimator->isLoaded())
     {
-        juce::Image frame = gifAnimator->getCurrentFrame();
-
-        // Apply color filter if set
-        if (currentFilter != ColorFilterType::None)
-        {
-            frame = applyColorFilter(frame, currentFilter);
-        }
-
         // Calculate scaled size maintaining aspect ratio
         float gifAspect = static_cast<float>(gifAnimator->getWidth()) /
                           static_cast<float>(gifAnimator->getHeight());
@@ -184,6 +78,10 @@ void GifDisplayComponent::paint(juce::Graphics& g)
             float pulseAmount = static_cast<float>(std::sin(currentBeatPhase * juce::MathConstants<double>::twoPi));
             float scale = 1.0f + pulseAmount * 0.08f; // ±8% scale
 
+            // Reactive: swell with the low band, up to +12%
+            if (audioReactive)
+                scale = 1.0f + audioEnvelope.bands[0] * 0.12f;
+
             auto center = drawArea.getCentre();
             float newWidth = drawArea.getWidth() * scale;
             float newHeight = drawArea.getHeight() * scale;
@@ -198,11 +96,43 @@ void GifDisplayComponent::paint(juce::Graphics& g)
         if (shakeEnabled)
         {
             float shakePhase = static_cast<float>(currentBeatPhase * juce::MathConstants<double>::twoPi * 4.0);
-            float shakeX = std::sin(shakePhase) * 4.0f;
-            float shakeY = std::cos(shakePhase * 1.3f) * 3.0f;
+            // Reactive: the high band and peaks set how far it shakes
+            float intensity = audioReactive ? (audioEnvelope.bands[2] + audioEnvelope.peak) : 1.0f;
+            float shakeX = std::sin(shakePhase) * 4.0f * intensity;
+            float shakeY = std::cos(shakePhase * 1.3f) * 3.0f * intensity;
             drawArea.translate(shakeX, shakeY);
         }
 
+        // Use the smallest mip level that still covers the physical draw size
+        float pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        juce::Image frame = gifAnimator->getCurrentFrameForSize(
+            static_cast<int>(std::ceil(drawArea.getWidth() * pixelScale)),
+            static_cast<int>(std::ceil(drawArea.getHeight() * pixelScale)));
+
+        // Apply color filter if set. Reactive mode blends it over the
+        // unfiltered frame by the input level.
+        if (currentFilter != ColorFilterType::None)
+        {
+            if (audioReactive)
+            {
+                g.drawImage(frame,
+                            drawArea.getX(), drawArea.getY(),
+                            drawArea.getWidth(), drawArea.getHeight(),
+                            0, 0,
+                            frame.getWidth(), frame.getHeight(),
+                            false);
+                g.setOpacity(audioEnvelope.rms);
+            }
+
+            // GIFs loaded ahead by the scene sequencer may come filtered
+            // already, at full size only; smaller mip levels are filtered here
+            const auto* prefiltered = gifAnimator->getPrefilteredFrame(currentFilter);
+            if (prefiltered != nullptr && prefiltered->getBounds() == frame.getBounds())
+                frame = *prefiltered;
+            else
+                frame = ColorFilter::apply(frame, currentFilter);
+        }
+
         // Draw the GIF frame directly without any blending effects
         g.drawImage(frame,
                     drawArea.getX(), drawArea.getY(),
@@ -210,6 +140,7 @@ void GifDisplayComponent::paint(juce::Graphics& g)
                     0, 0,
                     frame.getWidth(), frame.getHeight(),
                     false); // false = no interpolation artifacts
+        g.setOpacity(1.0f);
     }
     else
     {
@@ -218,6 +149,53 @@ void GifDisplayComponent::paint(juce::Graphics& g)
         g.setFont(16.0f);
         g.drawText("Select a GIF below", bounds, juce::Justification::centred);
     }
+
+    if (metrics != nullptr)
+    {
+        const auto paintEnd = juce::Time::getHighResolutionTicks();
+        metrics->addSample(PerformanceMetrics::Metric::PaintMs,
+                           juce::Time::highResolutionTicksToSeconds(paintEnd - paintStart) * 1000.0);
+
+        if (lastPaintTicks != 0)
+        {
+            double interval = juce::Time::highResolutionTicksToSeconds(paintStart - lastPaintTicks);
+            if (interval > 0.0)
+                metrics->addSample(PerformanceMetrics::Metric::FramesPerSecond, 1.0 / interval);
+        }
+        lastPaintTicks = paintStart;
+
+        if (hudVisible)
+            drawHud(g);
+    }
+}
+
+void GifDisplayComponent::setHudVisible(bool shouldShow)
+{
+    hudVisible = shouldShow;
+    repaint();
+}
+
+void GifDisplayComponent::drawHud(juce::Graphics& g)
+{
+    const int lineHeight = 14;
+    const int numLines = PerformanceMetrics::numMetrics;
+    auto panel = juce::Rectangle<int>(8, 8, 170, numLines * lineHeight + 8);
+
+    g.setColour(BopperLookAndFeel::Colors::background.withAlpha(0.75f));
+    g.fillRoundedRectangle(panel.toFloat(), 6.0f);
+
+    g.setFont(BopperLookAndFeel::getTechFont(11.0f));
+    auto line = panel.reduced(6, 4).removeFromTop(lineHeight);
+
+    for (int i = 0; i < numLines; ++i)
+    {
+        auto metric = static_cast<PerformanceMetrics::Metric>(i);
+        g.setColour(BopperLookAndFeel::Colors::textDim);
+        g.drawText(PerformanceMetrics::getName(metric), line, juce::Justification::centredLeft);
+        g.setColour(BopperLookAndFeel::Colors::neonGreen);
+        g.drawText(metrics->format(metric), line, juce::Justification::centredRight);
+        line.translate(0, lineHeight);
+    }
 }
 
 void GifDisplayComponent::resized()
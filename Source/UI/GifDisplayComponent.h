@@ -2,7 +2,9 @@
 
 #include <JuceHeader.h>
 #include "GIF/GifAnimator.h"
-#include "PluginProcessor.h"
+#include "Utils/AudioAnalysis.h"
+#include "Utils/ColorFilter.h"
+#include "Utils/PerformanceMetrics.h"
 
 class GifDisplayComponent : public juce::Component
 {
@@ -18,18 +20,31 @@ public:
     // Set effects for rendering
     void setEffects(ColorFilterType filter, bool pulse, bool shake, double beatPhase);
 
+    // Drive pulse, shake and filter mix from a smoothed 0-1 audio envelope
+    // (see AudioEnvelope) instead of the beat phase
+    void setAudioReactive(bool enabled, const AudioLevels& envelope);
+
     // Trigger repaint when frame changes
     void updateDisplay() { repaint(); }
 
+    // Paint time and frame rate are recorded here; the HUD shows all metrics
+    void setMetrics(PerformanceMetrics* newMetrics) { metrics = newMetrics; }
+    void setHudVisible(bool shouldShow);
+    bool isHudVisible() const { return hudVisible; }
+
 private:
-    // Apply color filter to an image
-    juce::Image applyColorFilter(const juce::Image& source, ColorFilterType filter);
+    void drawHud(juce::Graphics& g);
 
     GifAnimator* gifAnimator = nullptr;
+    PerformanceMetrics* metrics = nullptr;
+    bool hudVisible = false;
+    juce::int64 lastPaintTicks = 0;
 
     // Effect state
     ColorFilterType currentFilter = ColorFilterType::None;
     bool pulseEnabled = false;
     bool shakeEnabled = false;
     double currentBeatPhase = 0.0;
+    bool audioReactive = false;
+    AudioLevels audioEnvelope;
 };
@@ -0,0 +1,115 @@
+#include "AudioAnalysis.h"
+
+namespace
+{
+    constexpr double lowBandEdgeHz = 200.0;
+    constexpr double highBandEdgeHz = 2000.0;
+
+    // Share of the distance to a falling level covered per UI tick
+    constexpr float releaseAmount = 0.15f;
+
+    constexpr float floorDb = -60.0f;
+
+    float onePoleCoefficient(double cutoffHz, double sampleRate)
+    {
+        return static_cast<float>(1.0 - std::exp(-juce::MathConstants<double>::twoPi * cutoffHz / sampleRate));
+    }
+
+    float normalise(float level)
+    {
+        // Plain log10 rather than juce::Decibels: the core builds without
+        // juce_audio_basics
+        const float db = level > 0.0f ? std::max(20.0f * std::log10(level), floorDb) : floorDb;
+        return juce::jlimit(0.0f, 1.0f, (db - floorDb) / -floorDb);
+    }
+
+    float follow(float current, float target)
+    {
+        return target > current ? target : current + (target - current) * releaseAmount;
+    }
+}
+
+void AudioAnalyser::prepare(double sampleRate)
+{
+    if (sampleRate <= 0.0)
+        sampleRate = 44100.0;
+
+    lowCoefficient = onePoleCoefficient(lowBandEdgeHz, sampleRate);
+    midCoefficient = onePoleCoefficient(highBandEdgeHz, sampleRate);
+    reset();
+}
+
+void AudioAnalyser::reset()
+{
+    lowState = 0.0f;
+    midState = 0.0f;
+}
+
+AudioLevels AudioAnalyser::analyse(const float* const* channels, int numChannels, int numSamples)
+{
+    AudioLevels levels;
+    if (numChannels <= 0 || numSamples <= 0)
+        return levels;
+
+    const float gain = 1.0f / static_cast<float>(numChannels);
+    double sumSquares = 0.0;
+    std::array<double, AudioLevels::numBands> bandSquares{};
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float sample = 0.0f;
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float value = channels[channel][i];
+            levels.peak = juce::jmax(levels.peak, std::abs(value));
+            sample += value;
+        }
+        sample *= gain;
+
+        lowState += (sample - lowState) * lowCoefficient;
+        midState += (sample - midState) * midCoefficient;
+
+        const float low = lowState;
+        const float mid = midState - lowState;
+        const float high = sample - midState;
+
+        sumSquares += static_cast<double>(sample) * sample;
+        bandSquares[0] += static_cast<double>(low) * low;
+        bandSquares[1] += static_cast<double>(mid) * mid;
+        bandSquares[2] += static_cast<double>(high) * high;
+    }
+
+    levels.rms = static_cast<float>(std::sqrt(sumSquares / numSamples));
+    for (int band = 0; band < AudioLevels::numBands; ++band)
+        levels.bands[static_cast<size_t>(band)] = static_cast<float>(std::sqrt(bandSquares[static_cast<size_t>(band)] / numSamples));
+
+    // Keep the filters out of denormal range through silence
+    if (std::abs(lowState) < 1.0e-15f)
+        lowState = 0.0f;
+    if (std::abs(midState) < 1.0e-15f)
+        midState = 0.0f;
+
+    return levels;
+}
+
+void AudioEnvelope::update(const AudioLevels* blocks, int count)
+{
+    // Loudest block since the last tick, so short transients aren't missed
+    AudioLevels loudest;
+    for (int i = 0; i < count; ++i)
+    {
+        loudest.rms = juce::jmax(loudest.rms, blocks[i].rms);
+        loudest.peak = juce::jmax(loudest.peak, blocks[i].peak);
+        for (int band = 0; band < AudioLevels::numBands; ++band)
+            loudest.bands[static_cast<size_t>(band)] = juce::jmax(loudest.bands[static_cast<size_t>(band)],
+                                                                  blocks[i].bands[static_cast<size_t>(band)]);
+    }
+
+    envelope.rms = follow(envelope.rms, normalise(loudest.rms));
+    envelope.peak = follow(envelope.peak, normalise(loudest.peak));
+    for (int band = 0; band < AudioLevels::numBands; ++band)
+    {
+        auto& value = envelope.bands[static_cast<size_t>(band)];
+        value = follow(value, normalise(loudest.bands[static_cast<size_t>(band)]));
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LockFreeQueue.h"
+#include <array>
+
+// Levels of one audio block, linear amplitude
+struct AudioLevels
+{
+    // Low (below 200 Hz), mid, high (above 2 kHz)
+    static constexpr int numBands = 3;
+
+    float rms = 0.0f;
+    float peak = 0.0f;
+    std::array<float, numBands> bands{};
+};
+
+// Per-block RMS, peak and band levels of the input. Allocation free.
+class AudioAnalyser
+{
+public:
+    void prepare(double sampleRate);
+    void reset();
+
+    AudioLevels analyse(const float* const* channels, int numChannels, int numSamples);
+
+private:
+    // One-pole lowpasses at the band edges; the bands are their differences
+    float lowCoefficient = 0.0f;
+    float midCoefficient = 0.0f;
+    float lowState = 0.0f;
+    float midState = 0.0f;
+};
+
+// Hands AudioLevels from the audio thread to the message thread
+using AudioLevelsFifo = LockFreeQueue<AudioLevels, 512>;
+
+// Smooths the levels of the blocks that arrived since the last UI tick into
+// 0-1 values that effects can follow: fast attack, slower release, mapped
+// from a -60 dB to 0 dB range.
+class AudioEnvelope
+{
+public:
+    void update(const AudioLevels* blocks, int count);
+    void reset() { envelope = {}; }
+
+    const AudioLevels& get() const { return envelope; }
+
+private:
+    AudioLevels envelope;
+};
@@ -0,0 +1,367 @@
+#include "BeatTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    // About 86 onset frames per second at 44.1 kHz
+    constexpr double hopSeconds = 0.0116;
+
+    // Onset history searched for the tempo
+    constexpr double envelopeSeconds = 6.0;
+
+    // The lag search is split over this many hops
+    constexpr int numLagSlices = 4;
+
+    // Log compression of spectral magnitudes, so quiet onsets still count
+    constexpr float magnitudeCompression = 100.0f;
+
+    // Smoothing of the flux average that onsets must rise above
+    constexpr float fluxSmoothing = 0.05f;
+
+    // Input below this mean square is silence; after silenceSeconds of it the lock is dropped
+    constexpr double silenceLevel = 1.0e-8;
+    constexpr double silenceSeconds = 2.0;
+
+    // Tempo prior: log-Gaussian around preferredBpm, one octave wide
+    constexpr double preferredBpm = 120.0;
+    constexpr double priorOctaves = 1.0;
+
+    // Normalised autocorrelation needed to count as a beat
+    constexpr double minConfidence = 0.15;
+
+    // Share of each new estimate blended into the running tempo and phase
+    constexpr double tempoSmoothing = 0.25;
+    constexpr double phaseGain = 0.25;
+}
+
+void BeatTracker::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+    // Power-of-two hop nearest to hopSeconds, with an FFT of twice that
+    hopSize = 1 << static_cast<int>(std::lround(std::log2(sampleRate * hopSeconds)));
+    hopSize = std::clamp(hopSize, 64, 8192);
+    fftSize = hopSize * 2;
+    envelopeRate = sampleRate / hopSize;
+
+    input.assign(static_cast<size_t>(fftSize), 0.0f);
+    real.assign(static_cast<size_t>(fftSize), 0.0f);
+    imag.assign(static_cast<size_t>(fftSize), 0.0f);
+
+    window.resize(static_cast<size_t>(fftSize));
+    for (int n = 0; n < fftSize; ++n)
+        window[static_cast<size_t>(n)] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * n / fftSize));
+
+    twiddleCos.resize(static_cast<size_t>(fftSize / 2));
+    twiddleSin.resize(static_cast<size_t>(fftSize / 2));
+    for (int k = 0; k < fftSize / 2; ++k)
+    {
+        twiddleCos[static_cast<size_t>(k)] = static_cast<float>(std::cos(-2.0 * pi * k / fftSize));
+        twiddleSin[static_cast<size_t>(k)] = static_cast<float>(std::sin(-2.0 * pi * k / fftSize));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < fftSize)
+        ++bits;
+
+    bitReverse.resize(static_cast<size_t>(fftSize));
+    for (int n = 0; n < fftSize; ++n)
+    {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b)
+            reversed |= ((n >> b) & 1) << (bits - 1 - b);
+        bitReverse[static_cast<size_t>(n)] = reversed;
+    }
+
+    previousMagnitudes.assign(static_cast<size_t>(fftSize / 2), 0.0f);
+
+    const int envelopeLength = static_cast<int>(envelopeRate * envelopeSeconds);
+    envelope.assign(static_cast<size_t>(envelopeLength), 0.0f);
+    snapshot.assign(static_cast<size_t>(envelopeLength), 0.0f);
+
+    minLag = std::max(1, static_cast<int>(std::floor(envelopeRate * 60.0 / maxBpm)));
+    maxLag = std::min(envelopeLength / 2, static_cast<int>(std::ceil(envelopeRate * 60.0 / minBpm)));
+    lagScores.assign(static_cast<size_t>(maxLag) + 2, 0.0f);
+
+    reset();
+}
+
+void BeatTracker::reset()
+{
+    std::fill(input.begin(), input.end(), 0.0f);
+    std::fill(previousMagnitudes.begin(), previousMagnitudes.end(), 0.0f);
+    std::fill(envelope.begin(), envelope.end(), 0.0f);
+    inputPosition = 0;
+    samplesUntilHop = hopSize;
+    fluxMean = 0.0f;
+    silentHops = 0;
+    envelopeWrite = 0;
+    envelopeCount = 0;
+    estimateStage = 0;
+    hopsSinceSnapshot = 0;
+
+    bpm = preferredBpm;
+    ppq = 0.0;
+    samplesSincePpqUpdate = 0;
+    locked = false;
+}
+
+void BeatTracker::process(const float* const* channels, int numChannels, int numSamples)
+{
+    if (input.empty())
+        return;
+
+    const int mask = fftSize - 1;
+    const float gain = numChannels > 0 ? 1.0f / static_cast<float>(numChannels) : 0.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float sum = 0.0f;
+        for (int channel = 0; channel < numChannels; ++channel)
+            sum += channels[channel][i];
+
+        input[static_cast<size_t>(inputPosition)] = sum * gain;
+        inputPosition = (inputPosition + 1) & mask;
+        ++samplesSincePpqUpdate;
+
+        if (--samplesUntilHop == 0)
+        {
+            samplesUntilHop = hopSize;
+            updatePpq();
+            analyseHop();
+        }
+    }
+
+    updatePpq();
+}
+
+void BeatTracker::updatePpq()
+{
+    ppq += samplesSincePpqUpdate * bpm / (60.0 * sampleRate);
+    samplesSincePpqUpdate = 0;
+}
+
+void BeatTracker::analyseHop()
+{
+    const int mask = fftSize - 1;
+    double energy = 0.0;
+
+    // Oldest sample first, loaded in bit-reversed order for the FFT
+    for (int n = 0; n < fftSize; ++n)
+    {
+        const float sample = input[static_cast<size_t>((inputPosition + n) & mask)];
+        const auto slot = static_cast<size_t>(bitReverse[static_cast<size_t>(n)]);
+        real[slot] = sample * window[static_cast<size_t>(n)];
+        imag[slot] = 0.0f;
+
+        if (n >= fftSize - hopSize)
+            energy += static_cast<double>(sample) * sample;
+    }
+
+    fft();
+
+    // Spectral flux: how much the compressed spectrum rose since the last hop
+    float flux = 0.0f;
+    for (int k = 1; k < fftSize / 2; ++k)
+    {
+        const auto bin = static_cast<size_t>(k);
+        const float magnitude = std::log1p(magnitudeCompression * std::sqrt(real[bin] * real[bin] + imag[bin] * imag[bin]));
+        const float rise = magnitude - previousMagnitudes[bin];
+        if (rise > 0.0f)
+            flux += rise;
+        previousMagnitudes[bin] = magnitude;
+    }
+
+    // Onsets are what rises above the recent average
+    fluxMean += (flux - fluxMean) * fluxSmoothing;
+    float onset = std::max(0.0f, flux - fluxMean);
+
+    if (energy / hopSize < silenceLevel)
+    {
+        onset = 0.0f;
+        if (++silentHops > envelopeRate * silenceSeconds)
+            locked = false;
+    }
+    else
+    {
+        silentHops = 0;
+    }
+
+    const int length = static_cast<int>(envelope.size());
+    envelope[static_cast<size_t>(envelopeWrite)] = onset;
+    envelopeWrite = (envelopeWrite + 1) % length;
+    envelopeCount = std::min(envelopeCount + 1, length);
+    ++hopsSinceSnapshot;
+
+    advanceEstimate();
+}
+
+void BeatTracker::advanceEstimate()
+{
+    const int length = static_cast<int>(envelope.size());
+
+    // Wait for a full history
+    if (envelopeCount < length || maxLag <= minLag)
+        return;
+
+    if (estimateStage == 0)
+    {
+        // Oldest first
+        double energy = 0.0;
+        for (int n = 0; n < length; ++n)
+        {
+            const float value = envelope[static_cast<size_t>((envelopeWrite + n) % length)];
+            snapshot[static_cast<size_t>(n)] = value;
+            energy += static_cast<double>(value) * value;
+        }
+
+        snapshotEnergy = energy / length;
+        hopsSinceSnapshot = 0;
+        estimateStage = 1;
+        return;
+    }
+
+    if (estimateStage <= numLagSlices)
+    {
+        // Autocorrelation of the onset envelope for one slice of the lag range
+        const int lagsPerSlice = (maxLag - minLag + numLagSlices) / numLagSlices;
+        const int first = minLag + (estimateStage - 1) * lagsPerSlice;
+        const int last = std::min(maxLag, first + lagsPerSlice - 1);
+
+        for (int lag = first; lag <= last; ++lag)
+        {
+            double sum = 0.0;
+            for (int n = lag; n < length; ++n)
+                sum += static_cast<double>(snapshot[static_cast<size_t>(n)]) * snapshot[static_cast<size_t>(n - lag)];
+            lagScores[static_cast<size_t>(lag)] = static_cast<float>(sum / (length - lag));
+        }
+
+        ++estimateStage;
+        return;
+    }
+
+    const bool wasLocked = locked;
+    if (chooseTempo())
+        estimatePhase(!wasLocked);
+
+    estimateStage = 0;
+}
+
+bool BeatTracker::chooseTempo()
+{
+    if (snapshotEnergy <= 0.0)
+    {
+        locked = false;
+        return false;
+    }
+
+    const double preferredLag = envelopeRate * 60.0 / preferredBpm;
+    auto weighted = [&](int lag)
+    {
+        const double octaves = std::log2(lag / preferredLag) / priorOctaves;
+        return lagScores[static_cast<size_t>(lag)] * std::exp(-0.5 * octaves * octaves);
+    };
+
+    int bestLag = minLag;
+    double bestScore = weighted(minLag);
+    for (int lag = minLag + 1; lag <= maxLag; ++lag)
+    {
+        const double score = weighted(lag);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    if (lagScores[static_cast<size_t>(bestLag)] / snapshotEnergy < minConfidence)
+    {
+        locked = false;
+        return false;
+    }
+
+    // Parabolic fit through the neighbours for a fractional lag
+    double lag = bestLag;
+    if (bestLag > minLag && bestLag < maxLag)
+    {
+        const double left = weighted(bestLag - 1);
+        const double right = weighted(bestLag + 1);
+        const double curvature = left - 2.0 * bestScore + right;
+        if (curvature < 0.0)
+            lag += 0.5 * (left - right) / curvature;
+    }
+
+    const double estimate = std::clamp(60.0 * envelopeRate / lag, minBpm, maxBpm);
+    bpm = locked ? bpm + (estimate - bpm) * tempoSmoothing : estimate;
+    locked = true;
+    return true;
+}
+
+void BeatTracker::estimatePhase(bool snap)
+{
+    const int length = static_cast<int>(snapshot.size());
+    const double period = envelopeRate * 60.0 / bpm; // Hops per beat
+
+    // Comb filter: the offset whose beat grid collects the most onset energy
+    // is how many hops before the newest entry the last beat fell
+    int bestOffset = 0;
+    double bestSum = -1.0;
+    const int numOffsets = static_cast<int>(std::ceil(period));
+
+    for (int offset = 0; offset < numOffsets; ++offset)
+    {
+        double sum = 0.0;
+        // Stop at the last offset that still rounds inside the snapshot
+        for (double back = offset; back <= length - 1; back += period)
+            sum += snapshot[static_cast<size_t>(length - 1 - static_cast<int>(std::lround(back)))];
+
+        if (sum > bestSum)
+        {
+            bestSum = sum;
+            bestOffset = offset;
+        }
+    }
+
+    // Onsets register once they reach the centre of the analysis window, one
+    // hop back, and the search finished a few hops after the snapshot
+    const double latencyHops = (fftSize / 2) / static_cast<double>(hopSize);
+    const double hopsSinceBeat = bestOffset + hopsSinceSnapshot + latencyHops;
+    const double measuredPhase = hopsSinceBeat / period - std::floor(hopsSinceBeat / period);
+
+    double error = measuredPhase - (ppq - std::floor(ppq));
+    error -= std::floor(error + 0.5);
+
+    ppq += snap ? error : error * phaseGain;
+}
+
+void BeatTracker::fft()
+{
+    // Iterative radix-2; input is already in bit-reversed order
+    for (int size = 2; size <= fftSize; size <<= 1)
+    {
+        const int half = size / 2;
+        const int step = fftSize / size;
+
+        for (int start = 0; start < fftSize; start += size)
+        {
+            for (int k = 0; k < half; ++k)
+            {
+                const float wr = twiddleCos[static_cast<size_t>(k * step)];
+                const float wi = twiddleSin[static_cast<size_t>(k * step)];
+                const auto a = static_cast<size_t>(start + k);
+                const auto b = a + static_cast<size_t>(half);
+
+                const float tr = real[b] * wr - imag[b] * wi;
+                const float ti = real[b] * wi + imag[b] * wr;
+                real[b] = real[a] - tr;
+                imag[b] = imag[a] - ti;
+                real[a] += tr;
+                imag[a] += ti;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+// Follows the beat of live audio, for hosts that don't report a tempo and for
+// the Standalone app. Spectral flux onsets feed an autocorrelation tempo
+// estimate and a comb filter phase estimate, which steer a running BPM and
+// PPQ position.
+//
+// prepare() allocates everything; process() is allocation and lock free. The
+// tempo search is spread over several analysis hops, so a block costs at most
+// one FFT and one search slice per hop it contains.
+class BeatTracker
+{
+public:
+    static constexpr double minBpm = 60.0;
+    static constexpr double maxBpm = 200.0;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    void process(const float* const* channels, int numChannels, int numSamples);
+
+    double getBpm() const { return bpm; }
+    double getPpqPosition() const { return ppq; }
+
+    // True while the onsets are regular enough to follow
+    bool isLocked() const { return locked; }
+
+private:
+    void updatePpq();
+    void analyseHop();
+    void advanceEstimate();
+    bool chooseTempo();
+    void estimatePhase(bool snap);
+    void fft();
+
+    double sampleRate = 44100.0;
+    int hopSize = 512;
+    int fftSize = 1024;
+    double envelopeRate = 44100.0 / 512.0; // Onset envelope samples per second
+
+    // Last fftSize input samples (mono), as a ring
+    std::vector<float> input;
+    int inputPosition = 0;
+    int samplesUntilHop = 512;
+
+    std::vector<float> window;
+    std::vector<float> real, imag;
+    std::vector<float> twiddleCos, twiddleSin;
+    std::vector<int> bitReverse;
+    std::vector<float> previousMagnitudes;
+    float fluxMean = 0.0f;
+    int silentHops = 0;
+
+    // Onset strength per hop, as a ring, and the copy the tempo search works on
+    std::vector<float> envelope;
+    std::vector<float> snapshot;
+    int envelopeWrite = 0;
+    int envelopeCount = 0;
+
+    // Tempo search state
+    std::vector<float> lagScores;
+    int minLag = 0;
+    int maxLag = 0;
+    int estimateStage = 0;
+    int hopsSinceSnapshot = 0;
+    double snapshotEnergy = 0.0;
+
+    double bpm = 120.0;
+    double ppq = 0.0;
+    int samplesSincePpqUpdate = 0;
+    bool locked = false;
+};
@@ -37,4 +37,118 @@ public:
         int frameIdx = static_cast<int>(phase * totalFrames);
         return std::clamp(frameIdx, 0, totalFrames - 1);
     }
+
+    // How long one loop of the GIF lasts
+    enum class SyncMode
+    {
+        Beat = 0,   // One quarter note
+        Triplet,    // Two thirds of a quarter note
+        Dotted,     // A dotted quarter note
+        Bar,
+        TwoBars,
+        FourBars
+    };
+
+    static constexpr int numSyncModes = 6;
+
+    static const char* getSyncModeName(SyncMode mode)
+    {
+        switch (mode)
+        {
+            case SyncMode::Beat:     return "Beat";
+            case SyncMode::Triplet:  return "Triplet";
+            case SyncMode::Dotted:   return "Dotted";
+            case SyncMode::Bar:      return "Bar";
+            case SyncMode::TwoBars:  return "2 Bars";
+            case SyncMode::FourBars: return "4 Bars";
+        }
+        return "";
+    }
+
+    // Everything the loop position depends on besides the PPQ position itself
+    struct LoopSettings
+    {
+        SyncMode mode = SyncMode::Beat;
+
+        // Loop length multiplier 2^speedIndex: -2 = 4x faster, 0 = 1x, 4 = 1/16
+        int speedIndex = 0;
+        static constexpr int minSpeedIndex = -2;
+        static constexpr int maxSpeedIndex = 4;
+
+        int numerator = 4;
+        int denominator = 4;
+        double barStartPpq = 0.0;
+
+        bool operator==(const LoopSettings& other) const
+        {
+            return mode == other.mode && speedIndex == other.speedIndex
+                && numerator == other.numerator && denominator == other.denominator
+                && barStartPpq == other.barStartPpq;
+        }
+
+        bool operator!=(const LoopSettings& other) const { return !(*this == other); }
+    };
+
+    // PPQ position to loop position, precomputed from LoopSettings so every
+    // update costs one subtract and one multiply whatever the mode
+    struct LoopMapping
+    {
+        double originPpq = 0.0;
+        double loopsPerQuarter = 1.0;
+
+        // Loops completed since the origin; the fraction is the phase in the current loop
+        double loopPosition(double ppqPosition) const
+        {
+            return (ppqPosition - originPpq) * loopsPerQuarter;
+        }
+    };
+
+    // Length of one bar in quarter notes
+    static double barLengthPpq(int numerator, int denominator)
+    {
+        if (numerator <= 0 || denominator <= 0)
+            return 4.0;
+        return numerator * 4.0 / denominator;
+    }
+
+    static LoopMapping makeLoopMapping(const LoopSettings& settings)
+    {
+        const double barLength = barLengthPpq(settings.numerator, settings.denominator);
+
+        double loopLength = 1.0;
+        switch (settings.mode)
+        {
+            case SyncMode::Beat:     loopLength = 1.0; break;
+            case SyncMode::Triplet:  loopLength = 2.0 / 3.0; break;
+            case SyncMode::Dotted:   loopLength = 1.5; break;
+            case SyncMode::Bar:      loopLength = barLength; break;
+            case SyncMode::TwoBars:  loopLength = barLength * 2.0; break;
+            case SyncMode::FourBars: loopLength = barLength * 4.0; break;
+        }
+        loopLength = std::ldexp(loopLength, settings.speedIndex);
+
+        LoopMapping mapping;
+        mapping.loopsPerQuarter = 1.0 / loopLength;
+
+        const bool barAligned = settings.mode == SyncMode::Bar
+                             || settings.mode == SyncMode::TwoBars
+                             || settings.mode == SyncMode::FourBars;
+
+        if (barAligned)
+        {
+            // Loops start on a bar line. Loops spanning several bars start on
+            // bars that are a multiple of their length, counted from bar 1.
+            mapping.originPpq = settings.barStartPpq;
+
+            const auto barsPerLoop = static_cast<long long>(std::llround(loopLength / barLength));
+            if (barsPerLoop > 1)
+            {
+                const auto barIndex = static_cast<long long>(std::llround(settings.barStartPpq / barLength));
+                const auto barsIntoLoop = ((barIndex % barsPerLoop) + barsPerLoop) % barsPerLoop;
+                mapping.originPpq -= static_cast<double>(barsIntoLoop) * barLength;
+            }
+        }
+
+        return mapping;
+    }
 };
@@ -0,0 +1,131 @@
+#include "ColorFilter.h"
+#include "TraceRecorder.h"
+
+const char* ColorFilter::getName(ColorFilterType filter)
+{
+    switch (filter)
+    {
+        case ColorFilterType::None:      return "None";
+        case ColorFilterType::Invert:    return "Invert";
+        case ColorFilterType::Sepia:     return "Sepia";
+        case ColorFilterType::Cyberpunk: return "Cyber";
+        case ColorFilterType::Vaporwave: return "Vapor";
+        case ColorFilterType::Matrix:    return "Matrix";
+    }
+
+    return "None";
+}
+
+juce::Image ColorFilter::apply(const juce::Image& source, ColorFilterType filter)
+{
+    if (filter == ColorFilterType::None)
+        return source;
+
+    BOPPER_TRACE_SCOPE("ColorFilter::apply");
+
+    juce::Image filtered = source.createCopy();
+    juce::Image::BitmapData data(filtered, juce::Image::BitmapData::readWrite);
+
+    for (int y = 0; y < data.height; ++y)
+    {
+        for (int x = 0; x < data.width; ++x)
+        {
+            juce::Colour pixel = data.getPixelColour(x, y);
+
+            if (pixel.getAlpha() == 0)
+                continue;
+
+            juce::Colour newPixel;
+
+            switch (filter)
+            {
+                case ColorFilterType::Invert:
+                    newPixel = juce::Colour(
+                        static_cast<juce::uint8>(255 - pixel.getRed()),
+                        static_cast<juce::uint8>(255 - pixel.getGreen()),
+                        static_cast<juce::uint8>(255 - pixel.getBlue()),
+                        pixel.getAlpha());
+                    break;
+
+                case ColorFilterType::Sepia:
+                {
+                    float r = static_cast<float>(pixel.getRed());
+                    float g = static_cast<float>(pixel.getGreen());
+                    float b = static_cast<float>(pixel.getBlue());
+
+                    int newR = static_cast<int>(std::min(255.0f, r * 0.393f + g * 0.769f + b * 0.189f));
+                    int newG = static_cast<int>(std::min(255.0f, r * 0.349f + g * 0.686f + b * 0.168f));
+                    int newB = static_cast<int>(std::min(255.0f, r * 0.272f + g * 0.534f + b * 0.131f));
+
+                    newPixel = juce::Colour(
+                        static_cast<juce::uint8>(newR),
+                        static_cast<juce::uint8>(newG),
+                        static_cast<juce::uint8>(newB),
+                        pixel.getAlpha());
+                    break;
+                }
+
+                case ColorFilterType::Cyberpunk:
+                {
+                    // Cyan/pink tint - boost cyan and pink channels
+                    float r = static_cast<float>(pixel.getRed());
+                    float g = static_cast<float>(pixel.getGreen());
+                    float b = static_cast<float>(pixel.getBlue());
+
+                    // Shift toward cyan (boost G and B) and pink (boost R)
+                    int newR = static_cast<int>(std::min(255.0f, r * 1.1f + 20.0f));
+                    int newG = static_cast<int>(std::min(255.0f, g * 0.9f + b * 0.2f));
+                    int newB = static_cast<int>(std::min(255.0f, b * 1.2f + 30.0f));
+
+                    newPixel = juce::Colour(
+                        static_cast<juce::uint8>(newR),
+                        static_cast<juce::uint8>(newG),
+                        static_cast<juce::uint8>(newB),
+                        pixel.getAlpha());
+                    break;
+                }
+
+                case ColorFilterType::Vaporwave:
+                {
+                    // Purple/pink aesthetic
+                    float r = static_cast<float>(pixel.getRed());
+                    float g = static_cast<float>(pixel.getGreen());
+                    float b = static_cast<float>(pixel.getBlue());
+
+                    // Shift toward purple/magenta
+                    int newR = static_cast<int>(std::min(255.0f, r * 1.0f + b * 0.3f + 20.0f));
+                    int newG = static_cast<int>(std::min(255.0f, g * 0.6f));
+                    int newB = static_cast<int>(std::min(255.0f, b * 1.1f + r * 0.2f + 40.0f));
+
+                    newPixel = juce::Colour(
+                        static_cast<juce::uint8>(newR),
+                        static_cast<juce::uint8>(newG),
+                        static_cast<juce::uint8>(newB),
+                        pixel.getAlpha());
+                    break;
+                }
+
+                case ColorFilterType::Matrix:
+                {
+                    // Green terminal style
+                    float luma = pixel.getRed() * 0.299f + pixel.getGreen() * 0.587f + pixel.getBlue() * 0.114f;
+
+                    newPixel = juce::Colour(
+                        static_cast<juce::uint8>(luma * 0.2f),
+                        static_cast<juce::uint8>(std::min(255.0f, luma * 1.2f)),
+                        static_cast<juce::uint8>(luma * 0.3f),
+                        pixel.getAlpha());
+                    break;
+                }
+
+                default:
+                    newPixel = pixel;
+                    break;
+            }
+
+            data.setPixelColour(x, y, newPixel);
+        }
+    }
+
+    return filtered;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Effect types
+enum class ColorFilterType
+{
+    None = 0,
+    Invert,
+    Sepia,
+    Cyberpunk,  // Cyan/pink tint
+    Vaporwave,  // Purple/pink tint
+    Matrix      // Green tint
+};
+
+class ColorFilter
+{
+public:
+    // Return a filtered copy of the image (or the image itself for None)
+    static juce::Image apply(const juce::Image& source, ColorFilterType filter);
+
+    // Short name for menus and the host
+    static const char* getName(ColorFilterType filter);
+
+    static constexpr int numFilters = 6;
+};
@@ -0,0 +1,33 @@
+#include "InternalClock.h"
+
+void InternalClock::start()
+{
+    running = true;
+    segmentStartPpq = 0.0;
+    segmentSamples = 0;
+    segmentBpm = 0.0;
+    segmentSampleRate = 0.0;
+}
+
+double InternalClock::advance(int numSamples, double bpm, double sampleRate)
+{
+    if (bpm != segmentBpm || sampleRate != segmentSampleRate)
+    {
+        // Carry the position over into a segment at the new tempo
+        if (segmentSampleRate > 0.0)
+            segmentStartPpq = positionAt(segmentSamples);
+
+        segmentSamples = 0;
+        segmentBpm = bpm;
+        segmentSampleRate = sampleRate;
+    }
+
+    const double ppq = positionAt(segmentSamples);
+    segmentSamples += numSamples;
+    return ppq;
+}
+
+double InternalClock::positionAt(int64_t samples) const
+{
+    return segmentStartPpq + static_cast<double>(samples) * segmentBpm / (60.0 * segmentSampleRate);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+// Transport for when there is no host transport (the Standalone app). The
+// position is counted in audio samples, never read from a wall clock, so it
+// can't drift from the audio however long it runs: PPQ is the start of the
+// current tempo segment plus the samples played since, and a new segment
+// begins whenever the tempo or sample rate changes.
+//
+// Audio thread only.
+class InternalClock
+{
+public:
+    // Start again from beat 0
+    void start();
+    void stop() { running = false; }
+    bool isRunning() const { return running; }
+
+    // PPQ position at the start of a block of numSamples, then counts the block
+    double advance(int numSamples, double bpm, double sampleRate);
+
+private:
+    double positionAt(int64_t samples) const;
+
+    bool running = false;
+    double segmentStartPpq = 0.0;
+    int64_t segmentSamples = 0;
+    double segmentBpm = 0.0;
+    double segmentSampleRate = 0.0;
+};
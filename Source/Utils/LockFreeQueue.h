@@ -0,0 +1,42 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// Hands values from the audio thread to the message thread.
+// One producer and one consumer, no locks and no allocation.
+template <typename Type, int Capacity>
+class LockFreeQueue
+{
+public:
+    static constexpr int capacity = Capacity;
+
+    // Producer. Drops the value if the consumer has fallen behind.
+    bool push(const Type& value)
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 <= 0)
+            return false;
+
+        slots[static_cast<size_t>(scope.startIndex1)] = value;
+        return true;
+    }
+
+    // Consumer. Copies up to maxCount queued values, oldest first.
+    int pop(Type* destination, int maxCount)
+    {
+        const auto scope = fifo.read(juce::jmin(maxCount, fifo.getNumReady()));
+
+        int copied = 0;
+        for (int i = 0; i < scope.blockSize1; ++i)
+            destination[copied++] = slots[static_cast<size_t>(scope.startIndex1 + i)];
+        for (int i = 0; i < scope.blockSize2; ++i)
+            destination[copied++] = slots[static_cast<size_t>(scope.startIndex2 + i)];
+
+        return copied;
+    }
+
+private:
+    juce::AbstractFifo fifo{capacity};
+    std::array<Type, capacity> slots;
+};
@@ -0,0 +1,93 @@
+#include "MemoryAccountant.h"
+
+MemoryAccountant& MemoryAccountant::getInstance()
+{
+    static MemoryAccountant instance;
+    return instance;
+}
+
+void MemoryAccountant::setBudget(size_t bytes)
+{
+    const juce::ScopedLock sl(lock);
+    budget = bytes;
+}
+
+size_t MemoryAccountant::getBudget() const
+{
+    const juce::ScopedLock sl(lock);
+    return budget;
+}
+
+void MemoryAccountant::registerClient(Client* client)
+{
+    const juce::ScopedLock sl(lock);
+    residentBytes.emplace(client, 0);
+}
+
+void MemoryAccountant::unregisterClient(Client* client)
+{
+    const juce::ScopedLock sl(lock);
+    residentBytes.erase(client);
+}
+
+void MemoryAccountant::setResidentBytes(Client* client, size_t bytes)
+{
+    const juce::ScopedLock sl(lock);
+    jassert(residentBytes.count(client) > 0);
+    residentBytes[client] = bytes;
+}
+
+size_t MemoryAccountant::getTotalBytes() const
+{
+    const juce::ScopedLock sl(lock);
+    size_t total = 0;
+    for (const auto& entry : residentBytes)
+        total += entry.second;
+    return total;
+}
+
+size_t MemoryAccountant::getAvailableBytes(const Client* client) const
+{
+    const juce::ScopedLock sl(lock);
+    const size_t others = othersBytes(client);
+    return others < budget ? budget - others : 0;
+}
+
+bool MemoryAccountant::reserve(Client* client, size_t extraBytes)
+{
+    const juce::ScopedLock sl(lock);
+
+    auto fits = [&]
+    {
+        auto own = residentBytes.find(client);
+        size_t total = othersBytes(client) + (own != residentBytes.end() ? own->second : 0);
+        return total + extraBytes <= budget;
+    };
+
+    if (fits())
+        return true;
+
+    evictOthers(client);
+    return fits();
+}
+
+size_t MemoryAccountant::othersBytes(const Client* client) const
+{
+    size_t total = 0;
+    for (const auto& entry : residentBytes)
+        if (entry.first != client)
+            total += entry.second;
+    return total;
+}
+
+void MemoryAccountant::evictOthers(Client* client)
+{
+    for (auto& entry : residentBytes)
+    {
+        if (entry.first == client)
+            continue;
+
+        size_t released = entry.first->releaseCaches();
+        entry.second -= std::min(entry.second, released);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+// Process-wide tally of decoded image memory, shared by every Bopper instance
+// in the host, with a global budget.
+// Clients report their resident bytes; when a client needs more room than the
+// budget allows, the other clients are asked to drop their caches first.
+// Call from the message thread.
+class MemoryAccountant
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Free anything that can be rebuilt later and return the bytes released.
+        // The accountant deducts them itself, so don't report back from here.
+        virtual size_t releaseCaches() = 0;
+    };
+
+    static MemoryAccountant& getInstance();
+
+    static constexpr size_t defaultBudget = size_t(512) * 1024 * 1024;
+
+    void setBudget(size_t bytes);
+    size_t getBudget() const;
+
+    void registerClient(Client* client);
+    void unregisterClient(Client* client);
+
+    // Record a client's current resident bytes
+    void setResidentBytes(Client* client, size_t bytes);
+
+    size_t getTotalBytes() const;
+
+    // Bytes the client may hold in total next to what the other clients hold
+    // now. Evicts nothing; use reserve() to make room.
+    size_t getAvailableBytes(const Client* client) const;
+
+    // True if the client can grow by extraBytes. Other clients' caches are
+    // evicted if that makes it fit.
+    bool reserve(Client* client, size_t extraBytes);
+
+private:
+    MemoryAccountant() = default;
+
+    size_t othersBytes(const Client* client) const;
+    void evictOthers(Client* client);
+
+    juce::CriticalSection lock;
+    std::map<Client*, size_t> residentBytes;
+    size_t budget = defaultBudget;
+
+    JUCE_DECLARE_NON_COPYABLE(MemoryAccountant)
+};
@@ -0,0 +1,32 @@
+#include "MidiTriggers.h"
+
+std::optional<MidiTrigger> MidiTrigger::fromNote(int noteNumber)
+{
+    MidiTrigger trigger;
+
+    if (noteNumber == retriggerNote)
+    {
+        trigger.action = Action::Retrigger;
+    }
+    else if (noteNumber >= firstPresetNote && noteNumber < firstSlotNote)
+    {
+        trigger.action = Action::SelectPreset;
+        trigger.value = noteNumber - firstPresetNote;
+    }
+    else if (noteNumber >= firstSlotNote && noteNumber < firstSlotNote + 3)
+    {
+        trigger.action = Action::SelectSlot;
+        trigger.value = noteNumber - firstSlotNote;
+    }
+    else if (noteNumber >= firstFrameNote)
+    {
+        trigger.action = Action::JumpToFrame;
+        trigger.value = noteNumber - firstFrameNote;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    return trigger;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LockFreeQueue.h"
+#include <optional>
+
+// Note-on messages that steer the animation in MIDI trigger mode.
+//
+//   C1 (36)          restart the loop from the first frame
+//   C#1-D#1 (37-39)  switch to preset 1-3
+//   E1-F#1 (40-42)   switch to saved slot 1-3
+//   C2 (48) and up   jump to frame 0, 1, 2, ... (wrapping at the frame count)
+struct MidiTrigger
+{
+    enum class Action
+    {
+        Retrigger,
+        JumpToFrame,
+        SelectPreset,
+        SelectSlot
+    };
+
+    static constexpr int retriggerNote = 36;
+    static constexpr int firstPresetNote = 37;
+    static constexpr int firstSlotNote = 40;
+    static constexpr int firstFrameNote = 48;
+
+    // Trigger for a note-on, if the note is mapped
+    static std::optional<MidiTrigger> fromNote(int noteNumber);
+
+    Action action = Action::Retrigger;
+    int value = 0;          // Frame, preset or slot index
+    double ppqPosition = 0; // Musical time of the note
+    juce::int64 ticks = 0;  // High resolution tick count at which the note sounds
+};
+
+// Triggers from the audio thread to the editor, in the order they were played
+using MidiTriggerFifo = LockFreeQueue<MidiTrigger, 256>;
@@ -0,0 +1,51 @@
+#include "PerformanceMetrics.h"
+
+void PerformanceMetrics::set(Metric metric, double value)
+{
+    values[static_cast<size_t>(metric)].store(value, std::memory_order_relaxed);
+}
+
+void PerformanceMetrics::addSample(Metric metric, double value, double smoothing)
+{
+    // Single writer per metric, so a plain load/store is enough
+    auto& slot = values[static_cast<size_t>(metric)];
+    double previous = slot.load(std::memory_order_relaxed);
+    slot.store(previous + (value - previous) * smoothing, std::memory_order_relaxed);
+}
+
+double PerformanceMetrics::get(Metric metric) const
+{
+    return values[static_cast<size_t>(metric)].load(std::memory_order_relaxed);
+}
+
+const char* PerformanceMetrics::getName(Metric metric)
+{
+    switch (metric)
+    {
+        case Metric::PaintMs:         return "Paint";
+        case Metric::TimerJitterMs:   return "Timer jitter";
+        case Metric::FramesPerSecond: return "FPS";
+        case Metric::DroppedFrames:   return "Dropped frames";
+        case Metric::ResidentBytes:   return "Decoded";
+        case Metric::PhaseErrorMs:    return "Phase error";
+        case Metric::NumMetrics:      break;
+    }
+    return "";
+}
+
+juce::String PerformanceMetrics::format(Metric metric) const
+{
+    double value = get(metric);
+
+    switch (metric)
+    {
+        case Metric::PaintMs:
+        case Metric::TimerJitterMs:
+        case Metric::PhaseErrorMs:    return juce::String(value, 2) + " ms";
+        case Metric::FramesPerSecond: return juce::String(value, 1);
+        case Metric::DroppedFrames:   return juce::String(static_cast<juce::int64>(value));
+        case Metric::ResidentBytes:   return juce::File::descriptionOfSizeInBytes(static_cast<juce::int64>(value));
+        case Metric::NumMetrics:      break;
+    }
+    return {};
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// Live performance figures shown by the editor's HUD.
+// Each metric is a single atomic, written by one thread and readable from any.
+class PerformanceMetrics
+{
+public:
+    enum class Metric
+    {
+        PaintMs = 0,      // GIF display paint time
+        TimerJitterMs,    // Deviation of the UI timer from its 60 Hz period
+        FramesPerSecond,  // Effective display repaint rate
+        DroppedFrames,    // GIF frame changes skipped since load
+        ResidentBytes,    // Decoded frame memory held by the animator
+        PhaseErrorMs,     // How far the shown beat position is from the audio
+        NumMetrics
+    };
+
+    static constexpr int numMetrics = static_cast<int>(Metric::NumMetrics);
+
+    void set(Metric metric, double value);
+
+    // Blend a new sample into a running average (for noisy per-frame timings)
+    void addSample(Metric metric, double value, double smoothing = 0.1);
+
+    double get(Metric metric) const;
+
+    static const char* getName(Metric metric);
+
+    // Value with its unit, e.g. "2.31 ms"
+    juce::String format(Metric metric) const;
+
+private:
+    std::array<std::atomic<double>, numMetrics> values{};
+};
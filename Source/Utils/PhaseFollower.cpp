@@ -0,0 +1,34 @@
+#include "PhaseFollower.h"
+
+#include <algorithm>
+#include <cmath>
+
+double PhaseFollower::extrapolate(double nowSeconds, double targetPpq, double targetSeconds, double bpm)
+{
+    const double sinceTarget = std::clamp(nowSeconds - targetSeconds, 0.0, maxExtrapolationSeconds);
+    return targetPpq + sinceTarget * std::max(bpm, 0.0) / 60.0;
+}
+
+double PhaseFollower::update(double nowSeconds, double targetPpq, double targetSeconds, double bpm)
+{
+    const double beatsPerSecond = std::max(bpm, 0.0) / 60.0;
+    const double target = extrapolate(nowSeconds, targetPpq, targetSeconds, bpm);
+
+    const double elapsed = hasPosition ? std::max(nowSeconds - lastSeconds, 0.0) : 0.0;
+    const double predicted = position + elapsed * beatsPerSecond;
+    lastError = hasPosition ? target - predicted : 0.0;
+    lastSeconds = nowSeconds;
+
+    if (!hasPosition || stiffness <= 0.0 || elapsed > maxExtrapolationSeconds
+        || std::abs(lastError) > snapThreshold)
+    {
+        position = target;
+        hasPosition = true;
+        return position;
+    }
+
+    // Pull toward the target by a share that depends on time, not refresh rate
+    const double correction = lastError * (1.0 - std::exp(-stiffness * elapsed));
+    position = std::max(predicted + correction, position);
+    return position;
+}
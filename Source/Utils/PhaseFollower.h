@@ -0,0 +1,49 @@
+#pragma once
+
+// Smooths the PPQ position the display animates from. The audio thread only
+// reports the position once per block, so reading it raw at each refresh
+// stutters by up to a block, worse at large buffer sizes and through tempo
+// ramps. The follower extrapolates the last report to the refresh time and
+// runs its own position at the reported tempo, pulling it toward the target
+// like a phase-locked loop. Small errors are corrected smoothly, without ever
+// stepping backward; errors past the snap threshold are host loops and
+// relocations, and jump straight to the target.
+//
+// A handful of arithmetic operations per update; safe to call every refresh.
+class PhaseFollower
+{
+public:
+    // Share of the error corrected per second, as a rate: after 1/stiffness
+    // seconds about 63% of it is gone. Zero or less snaps to the target.
+    void setStiffness(double perSecond) { stiffness = perSecond; }
+    double getStiffness() const { return stiffness; }
+
+    // Errors larger than this, in beats, are discontinuities
+    void setSnapThreshold(double beats) { snapThreshold = beats; }
+
+    // Forget the position; the next update snaps. Call when the transport stops.
+    void reset() { hasPosition = false; }
+
+    // Position at nowSeconds, given the target was at targetPpq at
+    // targetSeconds and moves at bpm. Times share any seconds base.
+    double update(double nowSeconds, double targetPpq, double targetSeconds, double bpm);
+
+    // Target minus the free-running position at the last update, in beats
+    double getLastError() const { return lastError; }
+
+    // Where a target reported at targetSeconds is by nowSeconds. Stale
+    // reports are only carried forward maxExtrapolationSeconds.
+    static double extrapolate(double nowSeconds, double targetPpq, double targetSeconds, double bpm);
+
+private:
+    // Reports older than this are stale (the audio stopped), not extrapolated
+    static constexpr double maxExtrapolationSeconds = 0.5;
+
+    double stiffness = 10.0;
+    double snapThreshold = 0.25;
+
+    bool hasPosition = false;
+    double position = 0.0;
+    double lastSeconds = 0.0;
+    double lastError = 0.0;
+};
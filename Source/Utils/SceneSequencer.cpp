@@ -0,0 +1,28 @@
+#include "SceneSequencer.h"
+
+namespace
+{
+    // Positions a hair before a step boundary belong to the next step, so
+    // rounding in the host's PPQ doesn't show the old scene for a frame
+    constexpr double boundaryTolerance = 1.0e-6;
+
+    juce::int64 floorToStep(double steps)
+    {
+        return static_cast<juce::int64>(std::floor(steps + boundaryTolerance));
+    }
+}
+
+juce::int64 SceneSequencer::stepNumberAt(double ppqPosition, double barStartPpq, double barLengthPpq) const
+{
+    if (stepLength == StepLength::Beat || barLengthPpq <= 0.0)
+        return floorToStep(ppqPosition);
+
+    const auto barNumber = static_cast<juce::int64>(std::llround(barStartPpq / barLengthPpq));
+    return barNumber + floorToStep((ppqPosition - barStartPpq) / barLengthPpq);
+}
+
+const Scene& SceneSequencer::sceneForStep(juce::int64 stepNumber) const
+{
+    const auto index = ((stepNumber % numSteps) + numSteps) % numSteps;
+    return steps[static_cast<size_t>(index)];
+}
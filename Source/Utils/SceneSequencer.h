@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "BpmSync.h"
+#include "ColorFilter.h"
+#include <array>
+
+// What the display shows for one step of the scene pattern
+struct Scene
+{
+    // GIF to switch to: 0-2 are the presets, 3-5 the saved slots
+    static constexpr int keepGif = -1;
+    static constexpr int firstSlotGif = 3;
+    static constexpr int numGifs = 6;
+
+    int gif = keepGif;
+    ColorFilterType filter = ColorFilterType::None;
+    int speedDivisor = 0; // As BpmSync::LoopSettings::speedIndex
+    bool reverse = false;
+    bool pingPong = false;
+};
+
+// A repeating pattern of scenes, one per beat or per bar, played from the
+// transport position. Steps are counted from PPQ 0, so the pattern lines up
+// with the host's bars and any instance plays the same step at the same time.
+//
+// Edited and read on the message thread; the processor only stores it and
+// saves it with the plugin state.
+class SceneSequencer
+{
+public:
+    enum class StepLength
+    {
+        Beat,
+        Bar
+    };
+
+    static constexpr int maxSteps = 16;
+
+    void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+    bool isEnabled() const { return enabled; }
+
+    void setStepLength(StepLength length) { stepLength = length; }
+    StepLength getStepLength() const { return stepLength; }
+
+    void setNumSteps(int count) { numSteps = juce::jlimit(1, maxSteps, count); }
+    int getNumSteps() const { return numSteps; }
+
+    Scene& getStep(int index) { return steps[static_cast<size_t>(juce::jlimit(0, maxSteps - 1, index))]; }
+    const Scene& getStep(int index) const { return steps[static_cast<size_t>(juce::jlimit(0, maxSteps - 1, index))]; }
+
+    // Steps since PPQ 0 at ppqPosition. Bars are measured from the host's
+    // last bar start so time signature changes don't shift them.
+    juce::int64 stepNumberAt(double ppqPosition, double barStartPpq, double barLengthPpq) const;
+
+    // Scene of a step number; the pattern repeats every getNumSteps() steps
+    const Scene& sceneForStep(juce::int64 stepNumber) const;
+
+private:
+    bool enabled = false;
+    StepLength stepLength = StepLength::Bar;
+    int numSteps = 4;
+    std::array<Scene, maxSteps> steps;
+};
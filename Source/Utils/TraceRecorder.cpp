@@ -0,0 +1,172 @@
+#include "TraceRecorder.h"
+
+#include <thread>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        juce::int64 start;
+        juce::int64 end;
+    };
+
+    constexpr int maxThreads = 8;
+    constexpr uint32_t eventsPerThread = 16384; // power of two, ~40s of audio callbacks
+
+    // One writer per buffer; old events are overwritten once it wraps.
+    // writing is raised for the duration of each record() so readers can wait
+    // for a write that started before recording was switched off.
+    struct ThreadBuffer
+    {
+        std::atomic<juce::Thread::ThreadID> owner{nullptr};
+        std::atomic<uint32_t> written{0};
+        std::atomic<bool> writing{false};
+        bool isMessageThread = false;
+        Event events[eventsPerThread];
+    };
+
+    ThreadBuffer buffers[maxThreads];
+
+    ThreadBuffer* getBufferForThisThread()
+    {
+        const auto self = juce::Thread::getCurrentThreadId();
+
+        for (auto& buffer : buffers)
+        {
+            auto owner = buffer.owner.load(std::memory_order_acquire);
+            if (owner == self)
+                return &buffer;
+
+            if (owner == nullptr)
+            {
+                juce::Thread::ThreadID expected = nullptr;
+                if (buffer.owner.compare_exchange_strong(expected, self, std::memory_order_acq_rel))
+                {
+                    buffer.isMessageThread = juce::MessageManager::existsAndIsCurrentThread();
+                    return &buffer;
+                }
+            }
+        }
+
+        // More threads than buffers: their events are dropped
+        return nullptr;
+    }
+
+    // Spin until no thread is part-way through record(). Once recording is off
+    // no new write can start, so this returns quickly.
+    void waitForWriters()
+    {
+        for (auto& buffer : buffers)
+            while (buffer.writing.load(std::memory_order_seq_cst))
+                std::this_thread::yield();
+    }
+}
+
+std::atomic<bool> TraceRecorder::enabled{false};
+
+void TraceRecorder::setEnabled(bool shouldRecord)
+{
+    enabled.store(shouldRecord, std::memory_order_seq_cst);
+}
+
+void TraceRecorder::clear()
+{
+    jassert(!isEnabled());
+    waitForWriters();
+
+    for (auto& buffer : buffers)
+    {
+        buffer.written.store(0, std::memory_order_relaxed);
+        buffer.owner.store(nullptr, std::memory_order_release);
+    }
+}
+
+void TraceRecorder::record(const char* name, juce::int64 startTicks, juce::int64 endTicks)
+{
+    // A scope that started while recording was on may finish after it was
+    // switched off; its event is dropped rather than racing a reader
+    if (!isEnabled())
+        return;
+
+    auto* buffer = getBufferForThisThread();
+    if (buffer == nullptr)
+        return;
+
+    // Publish the write before re-checking, so a reader that switched
+    // recording off either sees this flag or this thread sees it switched off
+    buffer->writing.store(true, std::memory_order_seq_cst);
+
+    if (enabled.load(std::memory_order_seq_cst)
+        && buffer->owner.load(std::memory_order_relaxed) == juce::Thread::getCurrentThreadId())
+    {
+        const uint32_t index = buffer->written.load(std::memory_order_relaxed);
+        buffer->events[index & (eventsPerThread - 1)] = {name, startTicks, endTicks};
+        buffer->written.store(index + 1, std::memory_order_release);
+    }
+
+    buffer->writing.store(false, std::memory_order_release);
+}
+
+bool TraceRecorder::writeChromeTrace(const juce::File& file)
+{
+    jassert(!isEnabled());
+    waitForWriters();
+
+    juce::FileOutputStream out(file);
+    if (out.failedToOpen())
+        return false;
+
+    out.setPosition(0);
+    out.truncate();
+
+    // Timestamps are written in microseconds from the first recorded event
+    juce::int64 origin = std::numeric_limits<juce::int64>::max();
+    for (const auto& buffer : buffers)
+    {
+        const uint32_t count = std::min(buffer.written.load(std::memory_order_acquire), eventsPerThread);
+        for (uint32_t i = 0; i < count; ++i)
+            origin = std::min(origin, buffer.events[i].start);
+    }
+
+    const double microsPerTick = 1.0e6 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    bool first = true;
+
+    auto beginEvent = [&]
+    {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    out << "{\"traceEvents\":[";
+
+    for (int tid = 0; tid < maxThreads; ++tid)
+    {
+        const auto& buffer = buffers[tid];
+        const uint32_t written = buffer.written.load(std::memory_order_acquire);
+        if (written == 0)
+            continue;
+
+        beginEvent();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\""
+            << (buffer.isMessageThread ? juce::String("Message thread") : "Thread " + juce::String(tid))
+            << "\"}}";
+
+        // Oldest first, skipping anything the ring has already overwritten
+        const uint32_t firstIndex = written > eventsPerThread ? written - eventsPerThread : 0;
+        for (uint32_t i = firstIndex; i < written; ++i)
+        {
+            const auto& event = buffer.events[i & (eventsPerThread - 1)];
+            beginEvent();
+            out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << juce::String(static_cast<double>(event.start - origin) * microsPerTick, 3)
+                << ",\"dur\":" << juce::String(static_cast<double>(event.end - event.start) * microsPerTick, 3)
+                << "}";
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    out.flush();
+    return out.getStatus().wasOk();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// Build with BOPPER_TRACING=0 to compile every trace scope out entirely
+#ifndef BOPPER_TRACING
+ #define BOPPER_TRACING 1
+#endif
+
+// Scoped timing events for finding where the time goes, dumped on demand as
+// Chrome trace-event JSON (open in ui.perfetto.dev or chrome://tracing).
+//
+// Each thread writes into its own fixed ring buffer, claimed once with a
+// compare-and-swap, so recording never locks or allocates and is safe on the
+// audio thread. When recording is off a scope costs one relaxed atomic load.
+class TraceRecorder
+{
+public:
+    static void setEnabled(bool shouldRecord);
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Drop everything recorded so far. Call only while recording is off; waits
+    // for any record() already in flight to finish first.
+    static void clear();
+
+    // Record a finished event, or drop it if recording is off. name must outlive
+    // the recorder (a string literal).
+    static void record(const char* name, juce::int64 startTicks, juce::int64 endTicks);
+
+    // Write all recorded events to a Chrome trace JSON file. Call only while
+    // recording is off; waits for in-flight writes like clear().
+    static bool writeChromeTrace(const juce::File& file);
+
+    // Records the lifetime of a scope
+    class Scope
+    {
+    public:
+        explicit Scope(const char* eventName)
+            : name(eventName), start(isEnabled() ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~Scope()
+        {
+            if (start != 0)
+                record(name, start, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char* name;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#if BOPPER_TRACING
+ #define BOPPER_TRACE_CONCAT_INNER(a, b) a##b
+ #define BOPPER_TRACE_CONCAT(a, b) BOPPER_TRACE_CONCAT_INNER(a, b)
+ #define BOPPER_TRACE_SCOPE(name) TraceRecorder::Scope BOPPER_TRACE_CONCAT(bopperTraceScope, __LINE__)(name)
+#else
+ #define BOPPER_TRACE_SCOPE(name)
+#endif
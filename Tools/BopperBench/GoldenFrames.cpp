@@ -0,0 +1,29 @@
+#include "GoldenFrames.h"
+#include "EasyGifReader/EasyGifReader.h"
+
+uint64_t GoldenFrames::hashRGBA(const uint8_t* rgba, size_t bytes)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        hash ^= rgba[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::vector<uint64_t> GoldenFrames::hashDecodedFrames(const void* data, size_t size)
+{
+    EasyGifReader gif = EasyGifReader::openMemory(data, size);
+    const size_t frameBytes = static_cast<size_t>(gif.width()) * static_cast<size_t>(gif.height()) * 4;
+
+    std::vector<uint64_t> hashes;
+    auto frame = gif.begin();
+    for (int i = 0; i < gif.frameCount(); ++i)
+    {
+        if (i > 0)
+            ++frame;
+        hashes.push_back(hashRGBA(frame->pixels(), frameBytes));
+    }
+    return hashes;
+}
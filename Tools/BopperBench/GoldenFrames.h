@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-frame hashes used to check that decoder and loader output never change
+// by accident. Frames are hashed as straight-alpha RGBA rows, so the same
+// value is expected from the raw decoder and from converted juce::Images.
+namespace GoldenFrames
+{
+    // 64-bit FNV-1a over RGBA bytes
+    uint64_t hashRGBA(const uint8_t* rgba, size_t bytes);
+
+    // Hash every composited frame straight out of EasyGifReader.
+    // Throws EasyGifReader::Error if the GIF can't be decoded.
+    std::vector<uint64_t> hashDecodedFrames(const void* data, size_t size);
+}
@@ -0,0 +1,791 @@
+#include <JuceHeader.h>
+#include "GIF/GifLoader.h"
+#include "GIF/GifAnimator.h"
+#include "Utils/BpmSync.h"
+#include "Utils/ColorFilter.h"
+#include "Utils/PhaseFollower.h"
+#include "EasyGifReader/EasyGifReader.h"
+#include "GoldenFrames.h"
+#include "SyntheticGifs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <iostream>
+#include <vector>
+
+//
+// BopperBench - repeatable timings of the GIF pipeline without a DAW.
+//
+// Usage: BopperBench [--gifs <dir>] [--iterations <n>] [--blit-size <WxH>] [--output <file.json>]
+//        BopperBench --verify-golden [--update-golden] [--gifs <dir>] [--golden <file.json>]
+//        BopperBench --sync [--seconds <n>] [--output <file.json>]
+//
+// For every .gif in the directory it reports decode time, conversion time,
+// resident bytes, colour filter cost per pixel, scaled blit time and animator
+// update cost. Results are written as JSON (stdout unless --output is given).
+//
+// --verify-golden decodes the same GIFs plus synthetic edge cases through
+// EasyGifReader, GifLoader and the delta frame store, and compares every
+// frame's hash with the committed golden values. Exits non-zero on mismatch.
+// --update-golden rewrites the golden file from the current decoder output.
+//
+// --sync simulates a host transport (tempo changes, loops, jumps, varying
+// block sizes) and a 60 Hz display, and reports how far the frame Bopper
+// shows is from the ideal frame at the moment it reaches the screen, with
+// the raw reported position and with each Smooth Timing stiffness.
+//
+
+namespace
+{
+    struct Settings
+    {
+        juce::File gifsDirectory{BOPPER_GIFS_DIR};
+        juce::File outputFile;
+        juce::File goldenFile{BOPPER_GOLDEN_FILE};
+        bool verifyGolden = false;
+        bool updateGolden = false;
+        bool sync = false;
+        double syncSeconds = 120.0;
+        int iterations = 5;
+        int blitWidth = 468;
+        int blitHeight = 300;
+    };
+
+    class Stopwatch
+    {
+    public:
+        double elapsedMs() const
+        {
+            return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+        }
+
+    private:
+        juce::int64 start = juce::Time::getHighResolutionTicks();
+    };
+
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        size_t mid = values.size() / 2;
+        return values.size() % 2 == 0 ? (values[mid - 1] + values[mid]) * 0.5 : values[mid];
+    }
+
+    // Run a measurement several times and keep the median
+    template <typename Fn>
+    double medianOf(int iterations, Fn&& measure)
+    {
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; ++i)
+            samples.push_back(measure());
+        return median(samples);
+    }
+
+    // giflib decode and compositing only, without conversion to juce::Image
+    double measureDecodeMs(const juce::MemoryBlock& data)
+    {
+        Stopwatch stopwatch;
+        EasyGifReader gif = EasyGifReader::openMemory(data.getData(), data.getSize());
+
+        unsigned int sink = 0;
+        auto frame = gif.begin();
+        for (int i = 0; i < gif.frameCount(); ++i)
+        {
+            if (i > 0)
+                ++frame;
+            sink += frame->pixels()[0];
+        }
+
+        juce::ignoreUnused(sink);
+        return stopwatch.elapsedMs();
+    }
+
+    size_t residentBytes(const GifLoader::GifData& gif)
+    {
+        if (gif.deltaFrames != nullptr)
+            return gif.deltaFrames->getResidentBytes();
+
+        size_t bytes = 0;
+        for (const auto& frame : gif.frames)
+            bytes += static_cast<size_t>(frame.getWidth()) * static_cast<size_t>(frame.getHeight()) * 4;
+        return bytes;
+    }
+
+    const char* filterName(ColorFilterType filter)
+    {
+        switch (filter)
+        {
+            case ColorFilterType::None:      return "None";
+            case ColorFilterType::Invert:    return "Invert";
+            case ColorFilterType::Sepia:     return "Sepia";
+            case ColorFilterType::Cyberpunk: return "Cyberpunk";
+            case ColorFilterType::Vaporwave: return "Vaporwave";
+            case ColorFilterType::Matrix:    return "Matrix";
+        }
+        return "Unknown";
+    }
+
+    juce::var measureFilters(const juce::Image& frame, int iterations)
+    {
+        auto* result = new juce::DynamicObject();
+        const double pixels = static_cast<double>(frame.getWidth()) * static_cast<double>(frame.getHeight());
+
+        for (int f = static_cast<int>(ColorFilterType::Invert); f <= static_cast<int>(ColorFilterType::Matrix); ++f)
+        {
+            auto filter = static_cast<ColorFilterType>(f);
+            double ms = medianOf(iterations, [&]
+            {
+                Stopwatch stopwatch;
+                auto filtered = ColorFilter::apply(frame, filter);
+                juce::ignoreUnused(filtered);
+                return stopwatch.elapsedMs();
+            });
+
+            result->setProperty(filterName(filter), ms * 1.0e6 / pixels);
+        }
+
+        return juce::var(result);
+    }
+
+    // Average time to draw one frame scaled into the display area
+    double measureBlitMs(GifAnimator& animator, const Settings& settings, bool useMipLevels, int iterations)
+    {
+        juce::Image target(juce::Image::ARGB, settings.blitWidth, settings.blitHeight, true, juce::SoftwareImageType());
+        juce::Graphics g(target);
+
+        auto area = juce::Rectangle<float>(0.0f, 0.0f, static_cast<float>(settings.blitWidth), static_cast<float>(settings.blitHeight));
+        auto drawArea = juce::RectanglePlacement(juce::RectanglePlacement::centred)
+                            .appliedTo(juce::Rectangle<float>(0.0f, 0.0f,
+                                                              static_cast<float>(animator.getWidth()),
+                                                              static_cast<float>(animator.getHeight())),
+                                       area);
+
+        const int frameCount = animator.getFrameCount();
+
+        return medianOf(iterations, [&]
+        {
+            Stopwatch stopwatch;
+            for (int i = 0; i < frameCount; ++i)
+            {
+                // Step through frames the way a 1-beat loop would
+                double ppq = (i + 0.5) / frameCount;
+                animator.update(120.0, ppq, true);
+
+                const juce::Image& frame = useMipLevels
+                    ? animator.getCurrentFrameForSize(juce::roundToInt(drawArea.getWidth()), juce::roundToInt(drawArea.getHeight()))
+                    : animator.getCurrentFrame();
+
+                g.drawImage(frame,
+                            drawArea.getX(), drawArea.getY(), drawArea.getWidth(), drawArea.getHeight(),
+                            0, 0, frame.getWidth(), frame.getHeight());
+            }
+            return stopwatch.elapsedMs() / frameCount;
+        });
+    }
+
+    double measureUpdateNs(GifAnimator& animator)
+    {
+        constexpr int calls = 100000;
+        Stopwatch stopwatch;
+
+        for (int i = 0; i < calls; ++i)
+            animator.update(120.0, i * 0.01, true, i % 5, (i & 64) != 0, (i & 128) != 0);
+
+        return stopwatch.elapsedMs() * 1.0e6 / calls;
+    }
+
+    juce::var benchmarkFile(const juce::File& file, const Settings& settings)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty("file", file.getFileName());
+
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data))
+        {
+            result->setProperty("error", "could not read file");
+            return juce::var(result);
+        }
+
+        result->setProperty("fileBytes", static_cast<juce::int64>(data.getSize()));
+
+        std::optional<GifLoader::GifData> loaded;
+        double loadMs = medianOf(settings.iterations, [&]
+        {
+            Stopwatch stopwatch;
+            loaded = GifLoader::loadFromMemory(data.getData(), data.getSize());
+            return stopwatch.elapsedMs();
+        });
+
+        if (!loaded.has_value())
+        {
+            result->setProperty("error", "load failed");
+            return juce::var(result);
+        }
+
+        double decodeMs = medianOf(settings.iterations, [&] { return measureDecodeMs(data); });
+
+        result->setProperty("width", loaded->width);
+        result->setProperty("height", loaded->height);
+        result->setProperty("frames", static_cast<int>(loaded->frames.size()));
+        result->setProperty("decodeMs", decodeMs);
+        result->setProperty("loadMs", loadMs);
+        result->setProperty("conversionMs", std::max(0.0, loadMs - decodeMs));
+        result->setProperty("residentBytes", static_cast<juce::int64>(residentBytes(*loaded)));
+        result->setProperty("peakDecodeBytes", static_cast<juce::int64>(loaded->peakDecodeBytes));
+        result->setProperty("filterNsPerPixel", measureFilters(loaded->frames.front(), settings.iterations));
+
+        GifAnimator animator;
+        animator.loadGif(data.getData(), data.getSize());
+        result->setProperty("blitMs", measureBlitMs(animator, settings, false, settings.iterations));
+        result->setProperty("blitMipMs", measureBlitMs(animator, settings, true, settings.iterations));
+        result->setProperty("updateNs", measureUpdateNs(animator));
+
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // Golden-frame verification
+
+    struct GoldenCase
+    {
+        juce::String name;
+        juce::MemoryBlock data;
+    };
+
+    juce::String toHex(uint64_t hash)
+    {
+        return juce::String::toHexString(static_cast<juce::int64>(hash)).paddedLeft('0', 16);
+    }
+
+    // Hash an image the same way GoldenFrames hashes decoder output
+    uint64_t hashImage(const juce::Image& image)
+    {
+        juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readOnly);
+        std::vector<uint8_t> rgba(static_cast<size_t>(bitmap.width) * static_cast<size_t>(bitmap.height) * 4);
+        auto* out = rgba.data();
+
+        for (int y = 0; y < bitmap.height; ++y)
+        {
+            for (int x = 0; x < bitmap.width; ++x)
+            {
+                auto colour = bitmap.getPixelColour(x, y);
+                *out++ = colour.getRed();
+                *out++ = colour.getGreen();
+                *out++ = colour.getBlue();
+                *out++ = colour.getAlpha();
+            }
+        }
+
+        return GoldenFrames::hashRGBA(rgba.data(), rgba.size());
+    }
+
+    std::vector<GoldenCase> collectGoldenCases(const Settings& settings)
+    {
+        std::vector<GoldenCase> cases;
+
+        for (const auto& synthetic : SyntheticGifs::makeCases())
+            cases.push_back({synthetic.name, juce::MemoryBlock(synthetic.data.data(), synthetic.data.size())});
+
+        auto gifFiles = settings.gifsDirectory.findChildFiles(juce::File::findFiles, false, "*.gif");
+        gifFiles.sort();
+
+        for (const auto& file : gifFiles)
+        {
+            GoldenCase gifCase{file.getFileName(), {}};
+            file.loadFileAsData(gifCase.data);
+            cases.push_back(std::move(gifCase));
+        }
+
+        return cases;
+    }
+
+    // Compare one pipeline's frame hashes with the expected list
+    void compareHashes(const juce::String& caseName, const juce::String& stage,
+                       const std::vector<uint64_t>& actual, const juce::StringArray& expected,
+                       juce::StringArray& failures)
+    {
+        if (static_cast<int>(actual.size()) != expected.size())
+        {
+            failures.add(caseName + " [" + stage + "]: " + juce::String(static_cast<int>(actual.size()))
+                         + " frames, expected " + juce::String(expected.size()));
+            return;
+        }
+
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            if (toHex(actual[i]) != expected[static_cast<int>(i)])
+                failures.add(caseName + " [" + stage + "]: frame " + juce::String(static_cast<int>(i))
+                             + " is " + toHex(actual[i]) + ", expected " + expected[static_cast<int>(i)]);
+        }
+    }
+
+    void verifyCase(const GoldenCase& gifCase, const juce::StringArray& expected, juce::StringArray& failures)
+    {
+        const auto& name = gifCase.name;
+
+        // Raw decoder output
+        try
+        {
+            compareHashes(name, "decoder", GoldenFrames::hashDecodedFrames(gifCase.data.getData(), gifCase.data.getSize()),
+                          expected, failures);
+        }
+        catch (...)
+        {
+            failures.add(name + " [decoder]: decode failed");
+        }
+
+        // Full frames converted by GifLoader
+        auto full = GifLoader::loadFromMemory(gifCase.data.getData(), gifCase.data.getSize());
+        if (full.has_value())
+        {
+            std::vector<uint64_t> hashes;
+            for (const auto& frame : full->frames)
+                hashes.push_back(hashImage(frame));
+            compareHashes(name, "loader", hashes, expected, failures);
+        }
+        else
+        {
+            failures.add(name + " [loader]: load failed");
+        }
+
+        // Keyframe + delta storage, played forwards and then backwards
+        GifLoader::LoadOptions options;
+        options.keyframeInterval = 3;
+        auto deltas = GifLoader::loadFromMemory(gifCase.data.getData(), gifCase.data.getSize(), options);
+        if (deltas.has_value() && deltas->deltaFrames != nullptr)
+        {
+            const auto& store = *deltas->deltaFrames;
+            juce::Image canvas;
+            int canvasFrameIndex = -1;
+
+            std::vector<uint64_t> forward;
+            for (int i = 0; i < store.getFrameCount(); ++i)
+            {
+                store.renderFrame(i, canvas, canvasFrameIndex);
+                forward.push_back(hashImage(canvas));
+            }
+            compareHashes(name, "delta forward", forward, expected, failures);
+
+            std::vector<uint64_t> backward(static_cast<size_t>(store.getFrameCount()));
+            for (int i = store.getFrameCount(); --i >= 0;)
+            {
+                store.renderFrame(i, canvas, canvasFrameIndex);
+                backward[static_cast<size_t>(i)] = hashImage(canvas);
+            }
+            compareHashes(name, "delta backward", backward, expected, failures);
+        }
+        else
+        {
+            failures.add(name + " [delta]: load failed");
+        }
+    }
+
+    int runGoldenFrames(const Settings& settings)
+    {
+        auto cases = collectGoldenCases(settings);
+
+        if (settings.updateGolden)
+        {
+            auto* golden = new juce::DynamicObject();
+            for (const auto& gifCase : cases)
+            {
+                juce::Array<juce::var> hashes;
+                try
+                {
+                    for (auto hash : GoldenFrames::hashDecodedFrames(gifCase.data.getData(), gifCase.data.getSize()))
+                        hashes.add(toHex(hash));
+                }
+                catch (...)
+                {
+                    std::cerr << "Could not decode " << gifCase.name << std::endl;
+                    return 1;
+                }
+                golden->setProperty(gifCase.name, hashes);
+            }
+
+            if (!settings.goldenFile.replaceWithText(juce::JSON::toString(juce::var(golden)) + "\n"))
+            {
+                std::cerr << "Could not write " << settings.goldenFile.getFullPathName() << std::endl;
+                return 1;
+            }
+
+            std::cout << "Wrote golden hashes for " << cases.size() << " GIFs to "
+                      << settings.goldenFile.getFullPathName() << std::endl;
+            return 0;
+        }
+
+        auto golden = juce::JSON::parse(settings.goldenFile);
+        if (!golden.isObject())
+        {
+            std::cerr << "Could not read golden hashes from " << settings.goldenFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        juce::StringArray failures;
+        for (const auto& gifCase : cases)
+        {
+            const auto* expectedList = golden[juce::Identifier(gifCase.name)].getArray();
+            if (expectedList == nullptr)
+            {
+                failures.add(gifCase.name + ": no golden hashes (run with --update-golden)");
+                continue;
+            }
+
+            juce::StringArray expected;
+            for (const auto& hash : *expectedList)
+                expected.add(hash.toString());
+
+            verifyCase(gifCase, expected, failures);
+        }
+
+        for (const auto& failure : failures)
+            std::cerr << "FAIL " << failure << std::endl;
+
+        std::cout << cases.size() << " GIFs checked, " << failures.size() << " mismatches" << std::endl;
+        return failures.isEmpty() ? 0 : 1;
+    }
+
+    //==============================================================================
+    // Visual sync accuracy
+
+    // Host transport advancing in audio blocks of varying size. Tempo changes,
+    // loop wraps, jumps and stops happen at block boundaries, as in most hosts.
+    class SimulatedTransport
+    {
+    public:
+        static constexpr double sampleRate = 48000.0;
+
+        explicit SimulatedTransport(juce::int64 seed) : random(seed)
+        {
+            pickBlockLength();
+        }
+
+        double getBlockStart() const { return blockStart; }
+        double getBlockEnd() const { return blockStart + blockLength; }
+        double getPpq() const { return ppq; }
+        double getBpm() const { return bpm; }
+        bool isPlaying() const { return playing; }
+
+        // True transport position at any time inside the current block
+        double ppqAt(double time) const
+        {
+            if (!playing)
+                return ppq;
+
+            double position = ppq + (time - blockStart) * bpm / 60.0;
+            if (looping && position >= loopEnd)
+                position -= loopEnd - loopStart;
+            return position;
+        }
+
+        void nextBlock()
+        {
+            ppq = ppqAt(getBlockEnd());
+            blockStart = getBlockEnd();
+            pickBlockLength();
+
+            // Tempo change every 5 s
+            if (crossed(5.0))
+                bpm = 70.0 + random.nextDouble() * 110.0;
+
+            // Loop the 4 bars after beat 32 during the second half of every 30 s
+            looping = std::fmod(blockStart, 30.0) >= 15.0;
+            if (looping && (ppq < loopStart || ppq >= loopEnd) && crossed(15.0))
+                ppq = loopStart;
+
+            // Jump somewhere else every 11 s, unless looping
+            if (!looping && crossed(11.0))
+                ppq = random.nextDouble() * 64.0;
+
+            // Stop for a second every 20 s
+            playing = std::fmod(blockStart, 20.0) < 19.0;
+        }
+
+    private:
+        // True if a multiple of the period lies inside the block that just ended
+        bool crossed(double period) const
+        {
+            return std::floor(blockStart / period) != std::floor((blockStart - previousLength) / period);
+        }
+
+        void pickBlockLength()
+        {
+            const int blockSizes[] = {64, 128, 256, 480, 512, 1024};
+            previousLength = blockLength;
+            blockLength = blockSizes[random.nextInt(6)] / sampleRate;
+        }
+
+        juce::Random random;
+        double blockStart = 0.0;
+        double blockLength = 0.0;
+        double previousLength = 0.0;
+        double ppq = 0.0;
+        double bpm = 120.0;
+        bool playing = true;
+        bool looping = false;
+        static constexpr double loopStart = 32.0;
+        static constexpr double loopEnd = 48.0;
+    };
+
+    double percentile(std::vector<double> values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        auto index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+        return values[index];
+    }
+
+    juce::var describeDistribution(const std::vector<double>& values)
+    {
+        std::vector<double> magnitudes;
+        for (double value : values)
+            magnitudes.push_back(std::abs(value));
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("p50", percentile(magnitudes, 0.5));
+        result->setProperty("p95", percentile(magnitudes, 0.95));
+        result->setProperty("p99", percentile(magnitudes, 0.99));
+        result->setProperty("max", percentile(magnitudes, 1.0));
+        result->setProperty("meanSigned", values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size()));
+        return juce::var(result);
+    }
+
+    // How the shown animator gets its position: the editor's Smooth Timing
+    // choices, or the raw reported position when it is off
+    struct SyncTiming
+    {
+        const char* name;
+        double stiffness; // zero reads the reported position raw
+    };
+
+    const SyncTiming syncTimings[] = {{"Raw", 0.0}, {"Loose", 4.0}, {"Medium", 10.0}, {"Tight", 25.0}};
+
+    // One timing and speed/direction setting played against the simulated host
+    juce::var measureSync(const Settings& settings, const SyncTiming& timing, int speedDivisor, bool reverse, bool pingPong)
+    {
+        constexpr int frameCount = 24;
+        constexpr double displayRate = 60.0;
+
+        auto makeFrames = []
+        {
+            std::vector<juce::Image> frames;
+            for (int i = 0; i < frameCount; ++i)
+                frames.emplace_back(juce::Image::ARGB, 1, 1, true);
+            return frames;
+        };
+
+        // One animator driven the way the editor drives it, one from the true position
+        GifAnimator shown;
+        GifAnimator ideal;
+        shown.loadFrames(makeFrames());
+        ideal.loadFrames(makeFrames());
+
+        PhaseFollower follower;
+        follower.setStiffness(timing.stiffness);
+
+        SimulatedTransport transport(1234);
+        juce::Random timerJitter(5678);
+
+        std::vector<double> phaseErrorsMs;
+        std::vector<double> frameErrors;
+
+        for (int tick = 0; tick / displayRate < settings.syncSeconds; ++tick)
+        {
+            // The message thread timer fires late by up to a few milliseconds
+            const double timerTime = tick / displayRate + timerJitter.nextDouble() * 0.004;
+
+            // The block playing when the timer fires has published its start position
+            while (transport.getBlockEnd() <= timerTime)
+                transport.nextBlock();
+
+            // As the editor's getDisplayPpq: the block's position was reported
+            // at its start, and the follower carries it to the timer's time
+            double displayPpq = transport.getPpq();
+            if (timing.stiffness <= 0.0 || !transport.isPlaying())
+                follower.reset();
+            else
+                displayPpq = follower.update(timerTime, transport.getPpq(), transport.getBlockStart(), transport.getBpm());
+
+            shown.update(transport.getBpm(), displayPpq, transport.isPlaying(), speedDivisor, reverse, pingPong);
+
+            // The frame reaches the screen at the next vsync after painting
+            const double displayTime = std::ceil(timerTime * displayRate + 0.05) / displayRate;
+            auto atDisplay = transport;
+            while (atDisplay.getBlockEnd() <= displayTime)
+                atDisplay.nextBlock();
+
+            if (!transport.isPlaying() || !atDisplay.isPlaying())
+                continue;
+
+            ideal.update(atDisplay.getBpm(), atDisplay.ppqAt(displayTime), true, speedDivisor, reverse, pingPong);
+
+            // One phase cycle spans 2^speedDivisor beats
+            double phaseError = shown.getCurrentBeatPhase() - ideal.getCurrentBeatPhase();
+            phaseError -= std::floor(phaseError + 0.5);
+            phaseErrorsMs.push_back(phaseError * (1 << speedDivisor) * 60000.0 / atDisplay.getBpm());
+
+            int frameError = shown.getCurrentFrameIndex() - ideal.getCurrentFrameIndex();
+            if (!pingPong)
+                frameError = (frameError + frameCount + frameCount / 2) % frameCount - frameCount / 2;
+            frameErrors.push_back(frameError);
+        }
+
+        int exact = 0;
+        int withinOne = 0;
+        for (double error : frameErrors)
+        {
+            exact += error == 0.0 ? 1 : 0;
+            withinOne += std::abs(error) <= 1.0 ? 1 : 0;
+        }
+
+        const double samples = juce::jmax(1.0, static_cast<double>(frameErrors.size()));
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("timing", timing.name);
+        result->setProperty("stiffness", timing.stiffness);
+        result->setProperty("speedDivisor", speedDivisor);
+        result->setProperty("mode", pingPong ? "pingPong" : (reverse ? "reverse" : "forward"));
+        result->setProperty("samples", static_cast<int>(frameErrors.size()));
+        result->setProperty("phaseErrorMs", describeDistribution(phaseErrorsMs));
+        result->setProperty("frameError", describeDistribution(frameErrors));
+        result->setProperty("exactFramePercent", 100.0 * exact / samples);
+        result->setProperty("withinOneFramePercent", 100.0 * withinOne / samples);
+        return juce::var(result);
+    }
+
+    juce::var runSyncBenchmark(const Settings& settings)
+    {
+        juce::Array<juce::var> scenarios;
+        for (const auto& timing : syncTimings)
+        {
+            for (int speedDivisor = 0; speedDivisor <= 4; ++speedDivisor)
+            {
+                scenarios.add(measureSync(settings, timing, speedDivisor, false, false));
+                scenarios.add(measureSync(settings, timing, speedDivisor, true, false));
+                scenarios.add(measureSync(settings, timing, speedDivisor, false, true));
+            }
+        }
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("benchmark", "sync");
+        report->setProperty("seconds", settings.syncSeconds);
+        report->setProperty("displayRate", 60);
+        report->setProperty("frameCount", 24);
+        report->setProperty("scenarios", scenarios);
+        return juce::var(report);
+    }
+
+    //==============================================================================
+    int writeReport(const juce::var& report, const Settings& settings)
+    {
+        auto json = juce::JSON::toString(report);
+
+        if (settings.outputFile != juce::File())
+        {
+            if (!settings.outputFile.replaceWithText(json))
+            {
+                std::cerr << "Could not write " << settings.outputFile.getFullPathName() << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            std::cout << json << std::endl;
+        }
+
+        return 0;
+    }
+
+    bool parseArguments(const juce::StringArray& args, Settings& settings)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--gifs" && hasValue)
+                settings.gifsDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+            else if (arg == "--output" && hasValue)
+                settings.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+            else if (arg == "--golden" && hasValue)
+                settings.goldenFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+            else if (arg == "--verify-golden")
+                settings.verifyGolden = true;
+            else if (arg == "--update-golden")
+                settings.updateGolden = true;
+            else if (arg == "--sync")
+                settings.sync = true;
+            else if (arg == "--seconds" && hasValue)
+                settings.syncSeconds = juce::jmax(1.0, args[++i].getDoubleValue());
+            else if (arg == "--iterations" && hasValue)
+                settings.iterations = juce::jmax(1, args[++i].getIntValue());
+            else if (arg == "--blit-size" && hasValue)
+            {
+                auto size = args[++i];
+                settings.blitWidth = juce::jmax(1, size.upToFirstOccurrenceOf("x", false, true).getIntValue());
+                settings.blitHeight = juce::jmax(1, size.fromFirstOccurrenceOf("x", false, true).getIntValue());
+            }
+            else
+            {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::String::fromUTF8(argv[i]));
+
+    Settings settings;
+    if (!parseArguments(args, settings))
+    {
+        std::cerr << "Usage: BopperBench [--gifs <dir>] [--iterations <n>] [--blit-size <WxH>] [--output <file.json>]\n"
+                     "       BopperBench --verify-golden [--update-golden] [--gifs <dir>] [--golden <file.json>]\n"
+                     "       BopperBench --sync [--seconds <n>] [--output <file.json>]" << std::endl;
+        return 1;
+    }
+
+    if (settings.verifyGolden || settings.updateGolden)
+        return runGoldenFrames(settings);
+
+    if (settings.sync)
+        return writeReport(runSyncBenchmark(settings), settings);
+
+    auto gifFiles = settings.gifsDirectory.findChildFiles(juce::File::findFiles, false, "*.gif");
+    gifFiles.sort();
+
+    if (gifFiles.isEmpty())
+    {
+        std::cerr << "No GIFs found in " << settings.gifsDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::Array<juce::var> files;
+    for (const auto& file : gifFiles)
+        files.add(benchmarkFile(file, settings));
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "pipeline");
+    report->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+   #if JUCE_DEBUG
+    report->setProperty("buildType", "Debug");
+   #else
+    report->setProperty("buildType", "Release");
+   #endif
+    report->setProperty("iterations", settings.iterations);
+    report->setProperty("blitSize", juce::String(settings.blitWidth) + "x" + juce::String(settings.blitHeight));
+    report->setProperty("files", files);
+
+    return writeReport(juce::var(report), settings);
+}
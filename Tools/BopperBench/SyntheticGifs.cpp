@@ -0,0 +1,327 @@
+#include "SyntheticGifs.h"
+#include <algorithm>
+
+namespace
+{
+    int paletteBits(size_t entries)
+    {
+        int bits = 1;
+        while ((size_t(1) << bits) < entries)
+            ++bits;
+        return bits;
+    }
+
+    void writeByte(std::vector<uint8_t>& out, int value)
+    {
+        out.push_back(static_cast<uint8_t>(value & 0xff));
+    }
+
+    void writeWord(std::vector<uint8_t>& out, int value)
+    {
+        writeByte(out, value);
+        writeByte(out, value >> 8);
+    }
+
+    void writePalette(std::vector<uint8_t>& out, const std::vector<uint32_t>& palette, int bits)
+    {
+        for (size_t i = 0; i < (size_t(1) << bits); ++i)
+        {
+            uint32_t colour = i < palette.size() ? palette[i] : 0;
+            writeByte(out, static_cast<int>(colour >> 16));
+            writeByte(out, static_cast<int>(colour >> 8));
+            writeByte(out, static_cast<int>(colour));
+        }
+    }
+
+    // Rows in the order they are stored in the file
+    std::vector<int> rowOrder(int height, bool interlaced)
+    {
+        std::vector<int> rows;
+
+        if (!interlaced)
+        {
+            for (int y = 0; y < height; ++y)
+                rows.push_back(y);
+            return rows;
+        }
+
+        const int offsets[] = {0, 4, 2, 1};
+        const int steps[] = {8, 8, 4, 2};
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            for (int y = offsets[pass]; y < height; y += steps[pass])
+                rows.push_back(y);
+        }
+        return rows;
+    }
+
+    // LZW stream made only of literal codes. A clear code is sent before the
+    // dictionary would grow past the initial code width, so widths never change.
+    void writeImageData(std::vector<uint8_t>& out, const std::vector<uint8_t>& symbols, int minimumCodeSize)
+    {
+        const int clearCode = 1 << minimumCodeSize;
+        const int endCode = clearCode + 1;
+        const int codeWidth = minimumCodeSize + 1;
+        const int maxRun = std::max(1, (1 << minimumCodeSize) - 3);
+
+        std::vector<uint8_t> packed;
+        uint32_t bitBuffer = 0;
+        int bitCount = 0;
+
+        auto emit = [&](int code)
+        {
+            bitBuffer |= static_cast<uint32_t>(code) << bitCount;
+            bitCount += codeWidth;
+            while (bitCount >= 8)
+            {
+                packed.push_back(static_cast<uint8_t>(bitBuffer & 0xff));
+                bitBuffer >>= 8;
+                bitCount -= 8;
+            }
+        };
+
+        emit(clearCode);
+        int run = 0;
+        for (uint8_t symbol : symbols)
+        {
+            if (run == maxRun)
+            {
+                emit(clearCode);
+                run = 0;
+            }
+            emit(symbol);
+            ++run;
+        }
+        emit(endCode);
+
+        if (bitCount > 0)
+            packed.push_back(static_cast<uint8_t>(bitBuffer & 0xff));
+
+        writeByte(out, minimumCodeSize);
+        for (size_t pos = 0; pos < packed.size(); pos += 255)
+        {
+            size_t blockSize = std::min<size_t>(255, packed.size() - pos);
+            writeByte(out, static_cast<int>(blockSize));
+            out.insert(out.end(), packed.begin() + static_cast<std::ptrdiff_t>(pos),
+                       packed.begin() + static_cast<std::ptrdiff_t>(pos + blockSize));
+        }
+        writeByte(out, 0);
+    }
+
+    // Deterministic index pattern for a frame
+    std::vector<uint8_t> pattern(int width, int height, int seed, int colours)
+    {
+        std::vector<uint8_t> indices(static_cast<size_t>(width * height));
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+                indices[static_cast<size_t>(y * width + x)] = static_cast<uint8_t>((x * 3 + y * 5 + seed) % colours);
+        }
+        return indices;
+    }
+
+    SyntheticGifs::Frame makeFrame(int left, int top, int width, int height, int seed, int colours)
+    {
+        SyntheticGifs::Frame frame;
+        frame.left = left;
+        frame.top = top;
+        frame.width = width;
+        frame.height = height;
+        frame.indices = pattern(width, height, seed, colours);
+        return frame;
+    }
+
+    const std::vector<uint32_t> basePalette = {
+        0x000000, 0xff0000, 0x00ff00, 0x0000ff, 0xffff00, 0xff00ff, 0x00ffff, 0xffffff
+    };
+}
+
+std::vector<uint8_t> SyntheticGifs::encode(const Gif& gif)
+{
+    std::vector<uint8_t> out;
+    const char header[] = "GIF89a";
+    out.insert(out.end(), header, header + 6);
+
+    // Logical screen descriptor
+    int codeSize = gif.minimumCodeSize;
+    const int globalBits = gif.globalPalette.empty() ? 0 : paletteBits(gif.globalPalette.size());
+    codeSize = std::max(codeSize, globalBits);
+
+    writeWord(out, gif.width);
+    writeWord(out, gif.height);
+    writeByte(out, (globalBits > 0 ? 0x80 : 0) | 0x70 | (globalBits > 0 ? globalBits - 1 : 0));
+    writeByte(out, 0); // background colour
+    writeByte(out, 0); // aspect ratio
+
+    if (globalBits > 0)
+        writePalette(out, gif.globalPalette, globalBits);
+
+    // Loop forever
+    const uint8_t loopExtension[] = {0x21, 0xff, 0x0b, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0',
+                                     0x03, 0x01, 0x00, 0x00, 0x00};
+    out.insert(out.end(), loopExtension, loopExtension + sizeof(loopExtension));
+
+    for (const auto& frame : gif.frames)
+    {
+        // Graphics control extension
+        writeByte(out, 0x21);
+        writeByte(out, 0xf9);
+        writeByte(out, 4);
+        writeByte(out, (frame.disposal << 2) | (frame.transparentIndex >= 0 ? 1 : 0));
+        writeWord(out, frame.delayCentiseconds);
+        writeByte(out, std::max(0, frame.transparentIndex));
+        writeByte(out, 0);
+
+        // Image descriptor
+        const int localBits = frame.localPalette.empty() ? 0 : paletteBits(frame.localPalette.size());
+        writeByte(out, 0x2c);
+        writeWord(out, frame.left);
+        writeWord(out, frame.top);
+        writeWord(out, frame.width);
+        writeWord(out, frame.height);
+        writeByte(out, (localBits > 0 ? 0x80 : 0) | (frame.interlaced ? 0x40 : 0) | (localBits > 0 ? localBits - 1 : 0));
+
+        if (localBits > 0)
+            writePalette(out, frame.localPalette, localBits);
+
+        int maxIndex = 0;
+        for (uint8_t index : frame.indices)
+            maxIndex = std::max(maxIndex, static_cast<int>(index));
+
+        const int frameCodeSize = std::max({2, codeSize, localBits, paletteBits(static_cast<size_t>(maxIndex) + 1)});
+
+        std::vector<uint8_t> symbols;
+        symbols.reserve(frame.indices.size());
+        for (int y : rowOrder(frame.height, frame.interlaced))
+        {
+            auto row = frame.indices.begin() + static_cast<std::ptrdiff_t>(y * frame.width);
+            symbols.insert(symbols.end(), row, row + frame.width);
+        }
+
+        writeImageData(out, symbols, frameCodeSize);
+    }
+
+    writeByte(out, 0x3b);
+    return out;
+}
+
+std::vector<SyntheticGifs::Case> SyntheticGifs::makeCases()
+{
+    std::vector<Case> cases;
+    auto add = [&cases](const std::string& name, const Gif& gif)
+    {
+        cases.push_back({"synthetic/" + name, encode(gif)});
+    };
+
+    const int colours = static_cast<int>(basePalette.size());
+
+    {
+        // Partial frames with transparent pixels drawn over previous content
+        Gif gif{12, 10, basePalette, {}};
+        gif.frames.push_back(makeFrame(0, 0, 12, 10, 0, colours));
+        auto overlay = makeFrame(2, 2, 4, 4, 1, colours);
+        overlay.disposal = 1;
+        overlay.transparentIndex = 3;
+        gif.frames.push_back(overlay);
+        auto second = makeFrame(6, 3, 5, 6, 2, colours);
+        second.transparentIndex = 0;
+        gif.frames.push_back(second);
+        add("dispose-none-transparent", gif);
+    }
+
+    {
+        // DISPOSE_BACKGROUND clears the frame's area to transparent
+        Gif gif{12, 10, basePalette, {}};
+        gif.frames.push_back(makeFrame(0, 0, 12, 10, 3, colours));
+        auto cleared = makeFrame(1, 1, 6, 5, 4, colours);
+        cleared.disposal = 2;
+        gif.frames.push_back(cleared);
+        auto over = makeFrame(4, 3, 6, 6, 5, colours);
+        over.transparentIndex = 2;
+        gif.frames.push_back(over);
+        add("dispose-background", gif);
+    }
+
+    {
+        // DISPOSE_PREVIOUS restores what was under the frame
+        Gif gif{12, 10, basePalette, {}};
+        auto base = makeFrame(0, 0, 12, 10, 6, colours);
+        base.disposal = 1;
+        gif.frames.push_back(base);
+        auto restored = makeFrame(2, 1, 5, 5, 7, colours);
+        restored.disposal = 3;
+        gif.frames.push_back(restored);
+        auto restoredAgain = makeFrame(5, 4, 6, 5, 8, colours);
+        restoredAgain.disposal = 3;
+        restoredAgain.transparentIndex = 1;
+        gif.frames.push_back(restoredAgain);
+        auto kept = makeFrame(0, 6, 4, 4, 9, colours);
+        kept.disposal = 1;
+        gif.frames.push_back(kept);
+        auto last = makeFrame(3, 0, 3, 3, 10, colours);
+        last.disposal = 3;
+        gif.frames.push_back(last);
+        add("dispose-previous", gif);
+    }
+
+    {
+        // DISPOSE_PREVIOUS on a first frame that doesn't cover the canvas
+        Gif gif{12, 10, basePalette, {}};
+        auto first = makeFrame(3, 2, 6, 6, 11, colours);
+        first.disposal = 3;
+        gif.frames.push_back(first);
+        gif.frames.push_back(makeFrame(0, 0, 5, 5, 12, colours));
+        add("dispose-previous-first-frame", gif);
+    }
+
+    {
+        // Interlaced frames with heights that aren't multiples of 8
+        Gif gif{11, 13, basePalette, {}};
+        auto first = makeFrame(0, 0, 11, 13, 13, colours);
+        first.interlaced = true;
+        gif.frames.push_back(first);
+        auto second = makeFrame(1, 2, 9, 7, 14, colours);
+        second.interlaced = true;
+        gif.frames.push_back(second);
+        gif.frames.push_back(makeFrame(0, 0, 11, 13, 15, colours));
+        add("interlaced", gif);
+    }
+
+    {
+        // Every frame brings its own palette; the last one falls back to global
+        Gif gif{12, 10, basePalette, {}};
+        auto first = makeFrame(0, 0, 12, 10, 16, 4);
+        first.localPalette = {0x102030, 0x405060, 0x708090, 0xa0b0c0};
+        gif.frames.push_back(first);
+        auto second = makeFrame(2, 2, 8, 6, 17, 16);
+        for (uint32_t i = 0; i < 16; ++i)
+            second.localPalette.push_back(i * 0x0f0e0d);
+        gif.frames.push_back(second);
+        gif.frames.push_back(makeFrame(4, 4, 4, 4, 18, colours));
+        add("local-palettes", gif);
+    }
+
+    {
+        // Indices beyond the palette size (decoders map them to entry 0)
+        Gif gif{12, 10, {0x112233, 0x445566, 0x778899, 0xaabbcc}, {}};
+        gif.minimumCodeSize = 3;
+        gif.frames.push_back(makeFrame(0, 0, 12, 10, 19, 8));
+        auto partial = makeFrame(3, 3, 6, 4, 20, 8);
+        partial.transparentIndex = 6;
+        gif.frames.push_back(partial);
+        add("out-of-range-indices", gif);
+    }
+
+    {
+        // Frames that extend past the logical screen are clipped
+        Gif gif{12, 10, basePalette, {}};
+        gif.frames.push_back(makeFrame(0, 0, 12, 10, 21, colours));
+        auto overhang = makeFrame(8, 6, 8, 8, 22, colours);
+        overhang.disposal = 2;
+        gif.frames.push_back(overhang);
+        gif.frames.push_back(makeFrame(10, 0, 4, 3, 23, colours));
+        add("frame-outside-canvas", gif);
+    }
+
+    return cases;
+}
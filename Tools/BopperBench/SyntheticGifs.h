@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Small hand-built GIFs covering decoder edge cases that the sample GIFs
+// don't reliably hit (disposal modes, interlacing, local palettes, ...).
+namespace SyntheticGifs
+{
+    struct Frame
+    {
+        int left = 0;
+        int top = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> indices;        // width * height, row-major
+        std::vector<uint32_t> localPalette;  // 0xRRGGBB, empty = use global palette
+        int disposal = 0;                    // GIF disposal method 0-3
+        int transparentIndex = -1;
+        int delayCentiseconds = 10;
+        bool interlaced = false;
+    };
+
+    struct Gif
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> globalPalette; // 0xRRGGBB
+        std::vector<Frame> frames;
+        int minimumCodeSize = 0;             // 0 = derived from the palettes
+    };
+
+    struct Case
+    {
+        std::string name;
+        std::vector<uint8_t> data;
+    };
+
+    // Encode a GIF (LZW with literal codes only, which every decoder accepts)
+    std::vector<uint8_t> encode(const Gif& gif);
+
+    // All edge cases, in a stable order
+    std::vector<Case> makeCases();
+}
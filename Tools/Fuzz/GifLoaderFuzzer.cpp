@@ -0,0 +1,40 @@
+#include <JuceHeader.h>
+#include "GIF/GifLoader.h"
+
+//
+// libFuzzer target for GifLoader::loadFromMemory.
+//
+// Build with -DBOPPER_BUILD_FUZZERS=ON using Clang, then run e.g.
+//   GifLoaderFuzzer -max_total_time=600 corpus/ gifs/
+//
+// Limits are tighter than the plugin's defaults so that slow or oversized
+// inputs show up as rejected loads instead of fuzzer timeouts or OOMs.
+//
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    GifLoader::LoadOptions options;
+    options.maxCanvasPixels = juce::int64(2048) * 2048;
+    options.maxFrameCount = 512;
+    options.maxDecodeBytes = size_t(256) * 1024 * 1024;
+    options.maxDecodeMilliseconds = 2000;
+
+    // Cover full frames, deltas and downscaling from the same corpus
+    const uint8_t variant = size > 0 ? data[size - 1] : 0;
+    options.keyframeInterval = (variant & 1) != 0 ? 4 : 0;
+    options.maxDimension = (variant & 2) != 0 ? 64 : 0;
+    options.byteBudget = (variant & 4) != 0 ? size_t(4) * 1024 * 1024 : 0;
+
+    GifLoader::LoadStatus status = GifLoader::LoadStatus::Ok;
+    auto result = GifLoader::loadFromMemory(data, size, options, &status);
+
+    // A successful load always holds at least one frame of the reported size
+    if (result.has_value())
+    {
+        jassert(status == GifLoader::LoadStatus::Ok);
+        jassert(result->width > 0 && result->height > 0);
+        jassert(!result->frames.empty() || result->deltaFrames != nullptr);
+    }
+
+    return 0;
+}
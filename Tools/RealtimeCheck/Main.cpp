@@ -0,0 +1,338 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "Utils/TraceRecorder.h"
+#include "RealtimeGuard.h"
+
+#include <array>
+#include <iostream>
+
+//
+// RealtimeCheck - drives BopperAudioProcessor::processBlock with a fake host
+// transport across sample rates and buffer sizes, with parameters automated
+// between blocks, and fails if the audio thread allocates, locks or makes a
+// syscall.
+//
+// Usage: RealtimeCheck [--blocks <n>] [--trap]
+//
+// --trap raises SIGTRAP on the first violation, so running under a debugger
+// stops at the offending call. Worst-case and mean block cost are reported
+// as a share of each block's real-time duration.
+//
+
+namespace
+{
+    // Host transport that moves forward by one block per call, with tempo
+    // changes, stops and hosts that don't report some fields
+    class FakePlayHead : public juce::AudioPlayHead
+    {
+    public:
+        juce::Optional<PositionInfo> getPosition() const override { return position; }
+
+        void prepare(double newSampleRate)
+        {
+            sampleRate = newSampleRate;
+            blockCount = 0;
+            samplePosition = 0;
+            ppq = 0.0;
+        }
+
+        void advance(int numSamples)
+        {
+            const double tempos[] = {120.0, 174.5, 60.0, 99.9};
+            const double bpm = tempos[(blockCount / 100) % 4];
+            const bool playing = (blockCount / 250) % 4 != 3;
+            const bool reportsBpm = (blockCount / 500) % 5 != 4;
+
+            position = {};
+            position.setIsPlaying(playing);
+            position.setTimeInSamples(samplePosition);
+            position.setTimeInSeconds(static_cast<double>(samplePosition) / sampleRate);
+            position.setTimeSignature(juce::AudioPlayHead::TimeSignature{4, 4});
+            position.setPpqPosition(ppq);
+            if (reportsBpm)
+            {
+                position.setBpm(bpm);
+                position.setPpqPositionOfLastBarStart(std::floor(ppq / 4.0) * 4.0);
+            }
+
+            if (playing)
+            {
+                samplePosition += numSamples;
+                ppq += numSamples / sampleRate * bpm / 60.0;
+            }
+
+            ++blockCount;
+        }
+
+    private:
+        PositionInfo position;
+        double sampleRate = 44100.0;
+        int blockCount = 0;
+        juce::int64 samplePosition = 0;
+        double ppq = 0.0;
+    };
+
+    struct Settings
+    {
+        int blocks = 2000;
+        bool trap = false;
+    };
+
+    // Input the processor hears: noise, or noise with a click on every beat so
+    // the beat tracker locks and runs its phase search
+    struct InputSignal
+    {
+        bool clicks = false;
+        double clickBpm = 120.0;
+
+        // Note-ons at assorted sample offsets in every block, more than the
+        // trigger queue holds between the harness's occasional drains
+        bool midiNotes = false;
+    };
+
+    // Retrigger, preset, slot and frame notes, and one that isn't a trigger
+    constexpr int testNotes[] = {36, 37, 39, 41, 48, 60, 20};
+    constexpr int notesPerBlock = 6;
+    constexpr int blocksBetweenTriggerDrains = 200;
+
+    // Automation: the harness flips a few parameters between blocks. The
+    // settings queue is drained rarely, so pushes also meet a full queue.
+    constexpr int blocksBetweenParameterChanges = 7;
+    constexpr int blocksBetweenSettingsDrains = 500;
+
+    void changeParameters(BopperAudioProcessor& processor, int change)
+    {
+        using Ids = BopperAudioProcessor::ParameterIds;
+        auto& parameters = processor.getParameters();
+
+        auto* reverse = parameters.getParameter(Ids::reverse);
+        auto* colorFilter = parameters.getParameter(Ids::colorFilter);
+        reverse->setValueNotifyingHost(change % 2 == 0 ? 1.0f : 0.0f);
+        colorFilter->setValueNotifyingHost(colorFilter->convertTo0to1(static_cast<float>(change % ColorFilter::numFilters)));
+
+        if (change % 3 == 0)
+            parameters.getParameter(Ids::speed)->setValueNotifyingHost(static_cast<float>(change % 5) / 4.0f);
+    }
+
+    // Long enough to fill the beat tracker's onset history and lock
+    constexpr double clickRunSeconds = 8.0;
+
+    struct RunResult
+    {
+        int violations[RealtimeGuard::numViolations] = {};
+        double worstMs = 0.0;
+        double meanMs = 0.0;
+    };
+
+    RunResult runConfiguration(BopperAudioProcessor& processor, FakePlayHead* playHead,
+                               double sampleRate, int blockSize, int numBlocks, const InputSignal& input)
+    {
+        processor.setPlayHead(playHead);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        if (playHead != nullptr)
+            playHead->prepare(sampleRate);
+
+        juce::AudioBuffer<float> buffer(juce::jmax(processor.getTotalNumInputChannels(),
+                                                   processor.getTotalNumOutputChannels()), blockSize);
+        juce::MidiBuffer midi;
+        midi.ensureSize(notesPerBlock * 2 * 16);
+        juce::Random random(blockSize);
+        std::array<MidiTrigger, MidiTriggerFifo::capacity> drained;
+        std::array<BopperAudioProcessor::VisualSettingsChange, BopperAudioProcessor::VisualSettingsFifo::capacity> drainedSettings;
+
+        const auto samplesPerClick = static_cast<juce::int64>(sampleRate * 60.0 / input.clickBpm);
+        const auto clickLength = static_cast<juce::int64>(sampleRate * 0.01);
+        juce::int64 sampleCount = 0;
+
+        if (input.clicks)
+            numBlocks = juce::jmax(numBlocks, static_cast<int>(std::ceil(clickRunSeconds * sampleRate / blockSize)));
+
+        RunResult result;
+        double totalMs = 0.0;
+        RealtimeGuard::resetCounts();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                float sample = random.nextFloat() * 2.0f - 1.0f;
+
+                if (input.clicks)
+                {
+                    // Quiet noise with a 10 ms decaying burst on each beat
+                    const auto sinceClick = (sampleCount + i) % samplesPerClick;
+                    const float click = sinceClick < clickLength ? 1.0f - static_cast<float>(sinceClick) / clickLength : 0.0f;
+                    sample = sample * (0.02f + 0.9f * click);
+                }
+
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    buffer.setSample(channel, i, sample);
+            }
+            sampleCount += blockSize;
+
+            midi.clear();
+            if (input.midiNotes)
+            {
+                for (int n = 0; n < notesPerBlock; ++n)
+                {
+                    const int offset = random.nextInt(blockSize);
+                    const int note = testNotes[(block + n) % static_cast<int>(std::size(testNotes))];
+                    midi.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), offset);
+                    midi.addEvent(juce::MidiMessage::noteOff(1, note), juce::jmin(offset + 1, blockSize - 1));
+                }
+
+                // The editor drains the queue; here it mostly stays full
+                if (block % blocksBetweenTriggerDrains == 0)
+                    processor.getMidiTriggerFifo().pop(drained.data(), static_cast<int>(drained.size()));
+            }
+
+            if (block % blocksBetweenParameterChanges == 0)
+                changeParameters(processor, block / blocksBetweenParameterChanges);
+
+            if (block % blocksBetweenSettingsDrains == 0)
+                processor.getVisualSettingsFifo().pop(drainedSettings.data(), static_cast<int>(drainedSettings.size()));
+
+            if (playHead != nullptr)
+                playHead->advance(blockSize);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            RealtimeGuard::arm();
+            processor.processBlock(buffer, midi);
+            RealtimeGuard::disarm();
+            const auto end = juce::Time::getHighResolutionTicks();
+
+            double ms = juce::Time::highResolutionTicksToSeconds(end - start) * 1000.0;
+            result.worstMs = std::max(result.worstMs, ms);
+            totalMs += ms;
+        }
+
+        for (int v = 0; v < RealtimeGuard::numViolations; ++v)
+            result.violations[v] = RealtimeGuard::getCount(static_cast<RealtimeGuard::Violation>(v));
+
+        result.meanMs = totalMs / numBlocks;
+        processor.releaseResources();
+        processor.setPlayHead(nullptr);
+        return result;
+    }
+
+    bool parseArguments(const juce::StringArray& args, Settings& settings)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--blocks" && hasValue)
+                settings.blocks = juce::jmax(1, args[++i].getIntValue());
+            else if (arg == "--trap")
+                settings.trap = true;
+            else
+                return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::String::fromUTF8(argv[i]));
+
+    Settings settings;
+    if (!parseArguments(args, settings))
+    {
+        std::cerr << "Usage: RealtimeCheck [--blocks <n>] [--trap]" << std::endl;
+        return 1;
+    }
+
+    if (!RealtimeGuard::canDetectLocksAndSyscalls())
+        std::cout << "Note: only heap allocations are detected on this platform" << std::endl;
+
+    RealtimeGuard::setTrapOnViolation(settings.trap);
+
+    const double sampleRates[] = {44100.0, 48000.0, 88200.0, 96000.0, 192000.0};
+    const int blockSizes[] = {1, 16, 32, 64, 128, 256, 441, 512, 1024, 2048, 4096};
+
+    BopperAudioProcessor processor;
+    FakePlayHead playHead;
+    int failures = 0;
+    double worstLoad = 0.0;
+
+    for (int pass = 0; pass < 6; ++pass)
+    {
+        // Plain host, then with the trace recorder running, then a host without
+        // a play head (beat tracker, fed a click track so it locks), then that
+        // again fed through the sidechain, then the internal transport playing,
+        // then the plain host again with MIDI triggers on
+        const bool tracing = pass == 1;
+        const bool sidechain = pass >= 3 && pass <= 4;
+        const bool internalClock = pass == 4;
+        const bool midiTriggers = pass == 5;
+        auto* head = pass >= 2 && pass <= 4 ? nullptr : &playHead;
+        TraceRecorder::setEnabled(tracing);
+        processor.setInternalClockPlaying(internalClock);
+        processor.setMidiTriggersEnabled(midiTriggers);
+
+        if (sidechain)
+            processor.enableAllBuses();
+        else
+            processor.disableNonMainBuses();
+
+        for (double sampleRate : sampleRates)
+        {
+            for (int blockSize : blockSizes)
+            {
+                // Tempos across the tracker's range, including the slow end
+                // where the phase search reaches the oldest onsets
+                const double clickTempos[] = {60.0, 97.0, 120.0, 174.0};
+                InputSignal input;
+                input.clicks = head == nullptr && !internalClock;
+                input.clickBpm = clickTempos[(blockSize + static_cast<int>(sampleRate)) % 4];
+                input.midiNotes = midiTriggers;
+
+                auto result = runConfiguration(processor, head, sampleRate, blockSize, settings.blocks, input);
+
+                const double blockMs = blockSize * 1000.0 / sampleRate;
+                const double load = result.worstMs / blockMs;
+                worstLoad = std::max(worstLoad, load);
+
+                juce::String line;
+                line << juce::String(sampleRate, 0) << " Hz / " << blockSize << " samples"
+                     << (tracing ? " [trace]" : "") << (head == nullptr ? " [no play head]" : "")
+                     << (sidechain ? " [sidechain]" : "") << (internalClock ? " [internal clock]" : "")
+                     << (input.clicks ? " [clicks " + juce::String(input.clickBpm, 0) + " BPM]" : "")
+                     << (midiTriggers ? " [MIDI triggers]" : "")
+                     << ": worst " << juce::String(result.worstMs * 1000.0, 2) << " us ("
+                     << juce::String(load * 100.0, 3) << "% of block), mean "
+                     << juce::String(result.meanMs * 1000.0, 2) << " us";
+
+                bool failed = false;
+                for (int v = 0; v < RealtimeGuard::numViolations; ++v)
+                {
+                    if (result.violations[v] > 0)
+                    {
+                        line << ", " << result.violations[v] << " "
+                             << RealtimeGuard::getName(static_cast<RealtimeGuard::Violation>(v));
+                        failed = true;
+                    }
+                }
+
+                if (failed)
+                    ++failures;
+
+                std::cout << (failed ? "FAIL " : "ok   ") << line << std::endl;
+            }
+        }
+    }
+
+    TraceRecorder::setEnabled(false);
+
+    std::cout << "Worst block cost: " << juce::String(worstLoad * 100.0, 3) << "% of the block's duration" << std::endl;
+    std::cout << failures << " configurations with realtime violations" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,363 @@
+// The syscall hooks below replace libc functions that fortified headers
+// would otherwise define inline
+#ifdef _FORTIFY_SOURCE
+ #undef _FORTIFY_SOURCE
+#endif
+
+#include "RealtimeGuard.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__) && defined(__GLIBC__)
+ #define BOPPER_REALTIME_INTERPOSE 1
+ #include <dlfcn.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <semaphore.h>
+ #include <sys/mman.h>
+ #include <sys/select.h>
+ #include <cstdarg>
+ #include <ctime>
+ #include <unistd.h>
+#else
+ #define BOPPER_REALTIME_INTERPOSE 0
+#endif
+
+namespace
+{
+    thread_local bool armedOnThisThread = false;
+    std::atomic<int> counts[RealtimeGuard::numViolations]{};
+    std::atomic<bool> trapOnViolation{false};
+}
+
+void RealtimeGuard::arm()
+{
+    armedOnThisThread = true;
+}
+
+void RealtimeGuard::disarm()
+{
+    armedOnThisThread = false;
+}
+
+void RealtimeGuard::setTrapOnViolation(bool shouldTrap)
+{
+    trapOnViolation.store(shouldTrap);
+}
+
+void RealtimeGuard::resetCounts()
+{
+    for (auto& count : counts)
+        count.store(0);
+}
+
+int RealtimeGuard::getCount(Violation violation)
+{
+    return counts[static_cast<int>(violation)].load();
+}
+
+const char* RealtimeGuard::getName(Violation violation)
+{
+    switch (violation)
+    {
+        case Violation::Allocation:    return "allocations";
+        case Violation::Deallocation:  return "deallocations";
+        case Violation::Lock:          return "locks";
+        case Violation::Syscall:       return "syscalls";
+        case Violation::NumViolations: break;
+    }
+    return "";
+}
+
+bool RealtimeGuard::canDetectLocksAndSyscalls()
+{
+    return BOPPER_REALTIME_INTERPOSE != 0;
+}
+
+void RealtimeGuard::check(Violation violation)
+{
+    if (!armedOnThisThread)
+        return;
+
+    counts[static_cast<int>(violation)].fetch_add(1, std::memory_order_relaxed);
+
+   #ifdef SIGTRAP
+    if (trapOnViolation.load(std::memory_order_relaxed))
+        std::raise(SIGTRAP);
+   #endif
+}
+
+//==============================================================================
+// Heap allocation hooks
+
+using RealtimeGuard::Violation;
+
+#if BOPPER_REALTIME_INTERPOSE
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+// C allocations (giflib, libc internals) are caught here; operator new goes
+// straight to libc below so each allocation is only counted once
+extern "C" void* malloc(size_t size) noexcept
+{
+    RealtimeGuard::check(Violation::Allocation);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) noexcept
+{
+    RealtimeGuard::check(Violation::Allocation);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) noexcept
+{
+    RealtimeGuard::check(Violation::Allocation);
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        RealtimeGuard::check(Violation::Deallocation);
+    __libc_free(ptr);
+}
+#endif
+
+namespace
+{
+    void* rawAlloc(std::size_t size)
+    {
+       #if BOPPER_REALTIME_INTERPOSE
+        return __libc_malloc(size);
+       #else
+        return std::malloc(size);
+       #endif
+    }
+
+    void rawFree(void* ptr)
+    {
+       #if BOPPER_REALTIME_INTERPOSE
+        __libc_free(ptr);
+       #else
+        std::free(ptr);
+       #endif
+    }
+
+    void* rawAlignedAlloc(std::size_t size, std::size_t alignment)
+    {
+       #if defined(_WIN32)
+        return _aligned_malloc(size, alignment);
+       #else
+        void* ptr = nullptr;
+        if (alignment < sizeof(void*))
+            alignment = sizeof(void*);
+        return posix_memalign(&ptr, alignment, size) == 0 ? ptr : nullptr;
+       #endif
+    }
+
+    void rawAlignedFree(void* ptr)
+    {
+       #if defined(_WIN32)
+        _aligned_free(ptr);
+       #else
+        rawFree(ptr);
+       #endif
+    }
+}
+
+// The array and nothrow forms forward to these by default
+void* operator new(std::size_t size)
+{
+    RealtimeGuard::check(Violation::Allocation);
+    if (auto* ptr = rawAlloc(size > 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    RealtimeGuard::check(Violation::Allocation);
+    if (auto* ptr = rawAlignedAlloc(size > 0 ? size : 1, static_cast<std::size_t>(alignment)))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        RealtimeGuard::check(Violation::Deallocation);
+    rawFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    if (ptr != nullptr)
+        RealtimeGuard::check(Violation::Deallocation);
+    rawAlignedFree(ptr);
+}
+
+//==============================================================================
+// Lock and syscall hooks (glibc only)
+
+#if BOPPER_REALTIME_INTERPOSE
+namespace
+{
+    // Look up the libc definition that this executable's hook hides.
+    // Resolved on first use, since hooks can run before static initialisers.
+    void* nextSymbol(std::atomic<void*>& slot, const char* name)
+    {
+        void* fn = slot.load(std::memory_order_relaxed);
+        if (fn == nullptr)
+        {
+            fn = dlsym(RTLD_NEXT, name);
+            slot.store(fn, std::memory_order_relaxed);
+        }
+        return fn;
+    }
+}
+
+#define BOPPER_REAL(name) \
+    static std::atomic<void*> real_##name{nullptr}; \
+    auto* realFn = reinterpret_cast<decltype(&::name)>(nextSymbol(real_##name, #name))
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+    RealtimeGuard::check(Violation::Lock);
+    BOPPER_REAL(pthread_mutex_lock);
+    return realFn(mutex);
+}
+
+extern "C" int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+{
+    RealtimeGuard::check(Violation::Lock);
+    BOPPER_REAL(pthread_rwlock_rdlock);
+    return realFn(lock);
+}
+
+extern "C" int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+{
+    RealtimeGuard::check(Violation::Lock);
+    BOPPER_REAL(pthread_rwlock_wrlock);
+    return realFn(lock);
+}
+
+extern "C" int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+{
+    RealtimeGuard::check(Violation::Lock);
+    BOPPER_REAL(pthread_cond_wait);
+    return realFn(cond, mutex);
+}
+
+extern "C" int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime)
+{
+    RealtimeGuard::check(Violation::Lock);
+    BOPPER_REAL(pthread_cond_timedwait);
+    return realFn(cond, mutex, abstime);
+}
+
+extern "C" int sem_wait(sem_t* semaphore)
+{
+    RealtimeGuard::check(Violation::Lock);
+    BOPPER_REAL(sem_wait);
+    return realFn(semaphore);
+}
+
+extern "C" ssize_t read(int fd, void* buffer, size_t count)
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(read);
+    return realFn(fd, buffer, count);
+}
+
+extern "C" ssize_t write(int fd, const void* buffer, size_t count)
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(write);
+    return realFn(fd, buffer, count);
+}
+
+extern "C" int close(int fd)
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(close);
+    return realFn(fd);
+}
+
+extern "C" int nanosleep(const struct timespec* duration, struct timespec* remaining)
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(nanosleep);
+    return realFn(duration, remaining);
+}
+
+extern "C" int usleep(useconds_t microseconds)
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(usleep);
+    return realFn(microseconds);
+}
+
+extern "C" int sched_yield() noexcept
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(sched_yield);
+    return realFn();
+}
+
+extern "C" int poll(struct pollfd* fds, nfds_t count, int timeout)
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(poll);
+    return realFn(fds, count, timeout);
+}
+
+extern "C" int select(int count, fd_set* readFds, fd_set* writeFds, fd_set* exceptFds, struct timeval* timeout)
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(select);
+    return realFn(count, readFds, writeFds, exceptFds, timeout);
+}
+
+extern "C" void* mmap(void* address, size_t length, int protection, int flags, int fd, off_t offset) noexcept
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(mmap);
+    return realFn(address, length, protection, flags, fd, offset);
+}
+
+extern "C" int munmap(void* address, size_t length) noexcept
+{
+    RealtimeGuard::check(Violation::Syscall);
+    BOPPER_REAL(munmap);
+    return realFn(address, length);
+}
+
+// Raw syscalls, e.g. futex waits behind std::atomic::wait or contended mutexes
+extern "C" long syscall(long number, ...) noexcept
+{
+    RealtimeGuard::check(Violation::Syscall);
+
+    va_list args;
+    va_start(args, number);
+    long a = va_arg(args, long), b = va_arg(args, long), c = va_arg(args, long);
+    long d = va_arg(args, long), e = va_arg(args, long), f = va_arg(args, long);
+    va_end(args);
+
+    BOPPER_REAL(syscall);
+    return realFn(number, a, b, c, d, e, f);
+}
+
+#undef BOPPER_REAL
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+// Detects calls that must never happen on the audio thread.
+//
+// While armed, every heap allocation or release made by the arming thread is
+// counted. On Linux with glibc, blocking lock calls and common syscalls are
+// caught as well by interposing the libc symbols in this executable.
+namespace RealtimeGuard
+{
+    enum class Violation
+    {
+        Allocation = 0,
+        Deallocation,
+        Lock,
+        Syscall,
+        NumViolations
+    };
+
+    constexpr int numViolations = static_cast<int>(Violation::NumViolations);
+
+    // Start/stop checking the calling thread
+    void arm();
+    void disarm();
+
+    // Raise SIGTRAP on the first violation so a debugger stops at the call site
+    void setTrapOnViolation(bool shouldTrap);
+
+    void resetCounts();
+    int getCount(Violation violation);
+    const char* getName(Violation violation);
+
+    // False where only allocations can be detected
+    bool canDetectLocksAndSyscalls();
+
+    // Called by the hooks; counts a violation if the calling thread is armed
+    void check(Violation violation);
+}